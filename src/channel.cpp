@@ -0,0 +1,147 @@
+///
+/// @brief nanoJVM message channels and ej32/Channel natives
+///
+#include "channel.h"
+#include "ucode.h"      // Ucode, Thread, gPool
+#include "task.h"       // task_block, task_wake
+#include "gc.h"         // GC::sweep
+
+#define TBIT(t)         (1u << (t).tid)
+
+static U32  ld(U32 *p)  { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static void st(U32 *p, U32 v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+static bool cas(U32 *p, U32 o, U32 n) {
+    return __atomic_compare_exchange_n(p, &o, n, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+static void set(U32 *p, U32 b) { __atomic_or_fetch(p, b, __ATOMIC_SEQ_CST); }
+static void clr(U32 *p, U32 b) { __atomic_and_fetch(p, ~b, __ATOMIC_SEQ_CST); }
+
+int Channels::open(U32 cap) {
+    int i = 0;
+    while (i < CHAN_MAX && c[i].used) i++;
+    if (i == CHAN_MAX) {             /// close those of dropped Channel objects
+        gGC.sweep();
+        for (i = 0; i < CHAN_MAX && c[i].used; i++);
+    }
+    if (i == CHAN_MAX) throw "ERR: channel table full";
+    U32 n = 1;
+    while (n < cap && n < CHAN_SZ) n <<= 1;
+    Chan &x = c[i];
+    x.used = 1;
+    x.mask = n - 1;
+    x.head = x.tail = x.rwait = x.swait = 0;
+    for (U32 k = 0; k < n; k++) x.seq[k] = k;
+    return i;
+}
+Chan &Channels::get(int i) {
+    if (i < 0 || i >= CHAN_MAX || !c[i].used) throw "ERR: bad channel";
+    return c[i];
+}
+bool Channels::put(Chan &x, DU v) {
+    U32 p = ld(&x.tail);
+    for (;;) {
+        S32 d = (S32)(ld(&x.seq[p & x.mask]) - p);
+        if (d < 0) return false;     /// cell not received yet, full
+        if (d == 0 && cas(&x.tail, p, p + 1)) break;
+        p = ld(&x.tail);             /// another sender took it
+    }
+    x.v[p & x.mask] = v;
+    st(&x.seq[p & x.mask], p + 1);   /// publish
+    return true;
+}
+bool Channels::take(Chan &x, DU &v) {
+    U32 p = ld(&x.head);
+    for (;;) {
+        S32 d = (S32)(ld(&x.seq[p & x.mask]) - (p + 1));
+        if (d < 0) return false;     /// cell not sent yet, empty
+        if (d == 0 && cas(&x.head, p, p + 1)) break;
+        p = ld(&x.head);             /// another receiver took it
+    }
+    v = x.v[p & x.mask];
+    st(&x.seq[p & x.mask], p + x.mask + 1);  /// free for the next lap
+    return true;
+}
+void Channels::wake(U32 *set) {
+    for (U32 s = ld(set); s; s = ld(set)) {
+        U32 b = s & -s;              /// lowest tid first
+        if (cas(set, s, s & ~b)) { task_wake(__builtin_ctz(b)); return; }
+    }
+}
+///
+/// park until the other side made progress, the wait bit is set before
+/// the retry, i.e. a send/recv in between either is seen or wakes us
+///
+void Channels::send(Thread &t, int i, DU v) {
+    Chan &x = get(i);
+    while (!put(x, v)) {
+        set(&x.swait, TBIT(t));
+        if (put(x, v)) { clr(&x.swait, TBIT(t)); break; }
+        parked++;
+        task_block(t);
+    }
+    sent++;
+    if (ld(&x.rwait)) wake(&x.rwait);
+}
+DU Channels::recv(Thread &t, int i) {
+    Chan &x = get(i);
+    DU v;
+    while (!take(x, v)) {
+        set(&x.rwait, TBIT(t));
+        if (take(x, v)) { clr(&x.rwait, TBIT(t)); break; }
+        parked++;
+        task_block(t);
+    }
+    if (ld(&x.swait)) wake(&x.swait);
+    return v;
+}
+bool Channels::try_recv(int i, DU &v) {
+    Chan &x = get(i);
+    if (!take(x, v)) return false;
+    if (ld(&x.swait)) wake(&x.swait);
+    return true;
+}
+U32 Channels::size(int i) {
+    Chan &x = get(i);
+    return ld(&x.tail) - ld(&x.head);
+}
+void Channels::keep(U32 live) {
+    for (int i = 0; i < CHAN_MAX; i++) {
+        if (!(live & (1u << i))) c[i].used = 0;
+    }
+}
+///
+/// ej32/Channel natives, value and receiver stay on the stack (pinned)
+/// while the call may park
+///
+static void _send(Thread &t) {
+    gChan.send(t, CH_ID(t.peek(1)), t.TOS);
+    t.pop(); t.pop();
+}
+static void _recv(Thread &t) {
+    DU v = gChan.recv(t, CH_ID(t.TOS));
+    t.TOS = v;                        /// replaces the receiver
+}
+static void _try_recv(Thread &t) {   /// dflt when empty
+    DU v = t.pop();
+    gChan.try_recv(CH_ID(t.TOS), v);
+    t.TOS = v;
+}
+static void _try_recv_obj(Thread &t) {
+    DU v = 0;
+    gChan.try_recv(CH_ID(t.TOS), v);
+    t.TOS = v;
+}
+static Method _channel[] = {
+    { "<init>",     [](Thread &t){ CH_ID(t.peek(1)) = gChan.open(t.TOS); t.pop(); t.pop(); }, ACL_PUBLIC, "(I)V" },
+    { "send",       _send,         ACL_PUBLIC, "(I)V" },
+    { "send",       _send,         ACL_PUBLIC, "(Ljava/lang/Object;)V" },
+    { "recv",       _recv,         ACL_PUBLIC, "()I" },
+    { "recvObj",    _recv,         ACL_PUBLIC, "()Ljava/lang/Object;" },
+    { "tryRecv",    _try_recv,     ACL_PUBLIC, "(I)I" },
+    { "tryRecvObj", _try_recv_obj, ACL_PUBLIC, "()Ljava/lang/Object;" },
+    { "size",       [](Thread &t){ t.TOS = gChan.size(CH_ID(t.TOS)); },            ACL_PUBLIC, "()I" }
+};
+///
+/// ej32/Channel in ROM, registered by java_setup
+///
+Ucode uChannel(VTSZ(_channel), _channel);
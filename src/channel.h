@@ -0,0 +1,68 @@
+///
+/// @brief nanoJVM message channels (ej32/Channel), bounded rings between threads
+/// Note:
+///   * a per-VM table of CHAN_MAX rings of up to CHAN_SZ cells, a cell
+///     carries a DU value or an object reference, capacity is rounded up
+///     to a power of 2
+///   * lock free, multi-producer multi-consumer: every cell has a sequence
+///     number, senders claim a cell by CAS on tail, receivers on head, the
+///     value is published by the release store of the sequence number
+///   * send on a full, recv on an empty channel parks the thread in
+///     task_block(), i.e. the green scheduler or the OS runs others, each
+///     recv wakes one parked sender and each send one parked receiver
+///   * cells in flight are gc roots like stack cells, i.e. they pin objects
+///   * the Channel object keeps the index, gc closes channels whose
+///     object is gone, open() sweeps when the table is full
+///
+#ifndef NANOJVM_CHANNEL_H
+#define NANOJVM_CHANNEL_H
+#include "core.h"
+///
+/// ej32/Channel instance layout (ivsz = 1 cell)
+///
+#define CH_ID(ox)       (*(DU*)OBJ(ox)->data)   /** channel index */
+
+struct Chan {
+    U32  used;                    /// bound to a Channel object
+    U32  mask;                    /// capacity - 1
+    U32  head;                    /// next cell to receive
+    U32  tail;                    /// next cell to send
+    U32  rwait;                   /// threads parked in recv, bit per tid
+    U32  swait;                   /// threads parked in send, bit per tid
+    U32  seq[CHAN_SZ];            /// p: free for send p, p+1: holds value p
+    DU   v[CHAN_SZ];
+};
+struct Channels {
+    Chan c[CHAN_MAX];
+    IU   cx     = DATA_NA;        /// ej32/Channel class, set by java_setup
+    ///
+    /// statistics
+    ///
+    U32  sent   = 0;              /// values sent
+    U32  parked = 0;              /// times a thread parked on a channel
+
+    Channels() { memset(c, 0, sizeof(c)); }
+
+    int  open(U32 cap);                    /// new channel, returns its index
+    void send(Thread &t, int i, DU v);     /// parks while full
+    DU   recv(Thread &t, int i);           /// parks while empty
+    bool try_recv(int i, DU &v);           /// false: empty
+    U32  size(int i);                      /// values queued
+    void keep(U32 live);                   /// close channels not in live (bit per index)
+
+    template<typename F>
+    void roots(F f) {                      /// call f(DU) on each cell in flight
+        for (int i = 0; i < CHAN_MAX; i++) {
+            Chan &x = c[i];
+            if (!x.used) continue;
+            for (U32 p = x.head; p != x.tail; p++) f(x.v[p & x.mask]);
+        }
+    }
+
+private:
+    Chan &get(int i);
+    bool put(Chan &x, DU v);               /// false: full
+    bool take(Chan &x, DU &v);             /// false: empty
+    void wake(U32 *set);                   /// resume one thread of set
+};
+#endif // NANOJVM_CHANNEL_H
@@ -11,22 +11,70 @@ using namespace std;
 /// conditional compilation options
 ///
 #define RANGE_CHECK     1
-#define ENABLE_DEBUG    1
+#ifndef ENABLE_DEBUG
+#define ENABLE_DEBUG    0           /** loader and resolution logs    */
+#endif // ENABLE_DEBUG
+#ifndef ENABLE_TRACE
+#define ENABLE_TRACE    1           /** execution tracer (ring buffer) */
+#endif // ENABLE_TRACE
+#ifndef ENABLE_PROFILE
+#define ENABLE_PROFILE  1           /** opcode and word profiler       */
+#endif // ENABLE_PROFILE
 #define LOADER_DUMP     0
+#define CLSFILE_IMAGE   1           /** load class file into memory image */
+#define BC_QUICKEN      1           /** rewrite resolved bytecode into quick opcodes */
+#ifndef CGOTO_ENGINE
+#if defined(__GNUC__)
+#define CGOTO_ENGINE    1           /** direct-threaded JVM engine (labels-as-values) */
+#else
+#define CGOTO_ENGINE    0
+#endif // __GNUC__
+#endif // CGOTO_ENGINE
+#ifndef GREEN_THREAD
+#if ARDUINO
+#define GREEN_THREAD    1           /** java/lang/Thread multiplexed by the VM scheduler */
+#else
+#define GREEN_THREAD    0           /** java/lang/Thread on OS threads, VM lock */
+#endif // ARDUINO
+#endif // GREEN_THREAD
 ///
 /// memory block size setting
 ///
 #define CLSFILE_MAX      16         /** no. of classfile supported */
+#ifndef IU_BITS
+#if ARDUINO
+#define IU_BITS         16          /** compact, 16-bit pmem/heap addresses (64KB each) */
+#else
+#define IU_BITS         32          /** 32-bit pmem/heap addresses */
+#endif // ARDUINO
+#endif // IU_BITS
+#ifndef PMEM_SZ
 #define PMEM_SZ         1024*16     /** parameter space            */
+#endif // PMEM_SZ
+#ifndef HEAP_SZ
 #define HEAP_SZ         1024*16     /** object space               */
-#define RS_SZ           128         /** return stack size per VM   */
+#endif // HEAP_SZ
+#define RS_SZ           128         /** return stack size per thread */
 #define SS_SZ           256         /** data stack size per thread */
 #define CONST_SZ        128         /** constant pool size         */
 #define OP_LU_SZ        4			/** Forth opcode lookup table  */
 #define VT_LU_SZ        64          /** Java method lookup table   */
 #define CV_LU_SZ        16          /** max class variables        */
 #define IV_LU_SZ        16          /** max instance variables     */
-#define DATA_NA         0xffff      /** memory pool negate index   */
+#define IC_LU_SZ        32          /** invokevirtual call site caches */
+#define IC_WAYS         4           /** receiver classes per call site */
+#define HX_SZ           1024        /** dictionary hash index (power of 2) */
+#define TRACE_SZ        256         /** trace ring buffer records  */
+#define PROF_SZ         128         /** profiled words (power of 2) */
+#define GC_MARK_SZ      64          /** gc mark stack, heap rescan on overflow */
+#define FL_CLS          16          /** heap free list size classes (12..72 bytes) */
+#define TLAB_SZ         256         /** thread-local allocation buffer */
+#define TLAB_OBJ        64          /** largest object span taken from a TLAB */
+#define GC_ROOT_SZ      8           /** threads whose stacks gc scans */
+#define TASK_SZ         (GC_ROOT_SZ-1) /** java/lang/Thread running besides main */
+#define MON_SZ          16          /** inflated monitors (contended locks) */
+#define CHAN_MAX        8           /** message channels per VM */
+#define CHAN_SZ         64          /** cells per channel (power of 2) */
 ///
 /// Arduino support macros
 ///
@@ -34,6 +82,8 @@ using namespace std;
 #include <Arduino.h>
 #include "SPIFFS.h"
 #include "FS.h"
+#define VM_QUANTUM      100         /** opcodes per time slice, keeps watchdog fed */
+#define TASK_STACK      8192        /** FreeRTOS stack of a java/lang/Thread */
 ///
 /// ESP32 memory map (flash 4M, File system size:1,2,3M)
 /// |--------------|-------|---------------|--|--|--|--|--|
@@ -49,6 +99,8 @@ using namespace std;
 #define delay(ms)       this_thread::sleep_for(chrono::milliseconds(ms))
 #define yield()         this_thread::yield()
 #define PROGMEM
+#define VM_QUANTUM      10000       /** opcodes per time slice */
+#define TASK_STACK      0x40000     /** native stack of a green thread */
 #endif // ARDUINO
 ///
 /// universal types
@@ -67,14 +119,27 @@ typedef uintptr_t   P32;
 ///
 /// logical size: instruction, data, and pointer units
 ///
+///   IU addresses pmem and heap, its width is set by IU_BITS
+///   DU is a JVM slot, 32-bit in both, long and double take two
+///
+#if IU_BITS == 16
 typedef U16         IU;
+#elif IU_BITS == 32
+typedef U32         IU;
+#else
+#error "IU_BITS must be 16 or 32"
+#endif // IU_BITS
 typedef S32         DU;
 typedef P32         PU;
+#define DATA_NA         ((IU)~0)    /** memory pool negate index   */
+static_assert(PMEM_SZ < (U64)DATA_NA - 2 && HEAP_SZ < (U64)DATA_NA - 2,
+              "PMEM_SZ/HEAP_SZ exceed the IU address range, raise IU_BITS");
 ///
 /// memory alignment macros
 ///
 #define ALIGN(sz)   ((sz) + (-(sz) & 0x1))  /** 2-byte alignment  */
 #define ALIGN16(sz) ((sz) + (-(sz) & 0xf))  /** 16-byte alignment */
+#define ALIGN_DU(sz) ((sz) + (-(sz) & (sizeof(DU) - 1)))  /** cell alignment */
 #define STRLEN(s)   (ALIGN(strlen(s)+1))    /** calculate string size with alignment */
 ///
 /// console and file/SPIFFS IO macros
@@ -83,6 +148,7 @@ typedef P32         PU;
 #define LOG(s)      Serial.print(s)
 #define CHR(c)      Serial.print((char)(c))
 #define LOX(h)      Serial.print(h, HEX)
+#define LOU(u)      Serial.print((unsigned long)(u))
 #define LOX2(h)     LOX((h)>>4); LOX((h)&0xf)
 #define LOX4(h)     LOX2((h)>>8); LOX2((h)&0xff)
 #define FSIZE(f)    f.size()
@@ -92,10 +158,18 @@ typedef P32         PU;
 #define LOG(s)      printf("%s", s)
 #define CHR(c)      printf("%c", (char)c)
 #define LOX(h)      printf("%x", h)
+#define LOU(u)      printf("%lu", (unsigned long)(u))
 #define LOX2(h)     printf("%02x", (U8)(h))
 #define LOX4(h)     printf("%04x", h)
 #define FSIZE(f)    (fseek(f, 0L, SEEK_END), ftell(f))
 #define FSEEK(f, o) fseek(f, o, SEEK_SET)
 #define FGETC(f)    ((U8)fgetc(f))
 #endif // ARDUINO
+#if ENABLE_DEBUG
+#define DLOG(s)     LOG(s)
+#define DLOX(h)     LOX(h)
+#else
+#define DLOG(s)
+#define DLOX(h)
+#endif // ENABLE_DEBUG
 #endif // NANOJVM_COMMON_H
@@ -23,12 +23,12 @@ struct List {
         throw "ERR: List empty";
     }
     int push(T t) {
-        if (idx<N) { v[max=idx] = t; return idx++; }
+        if (idx<N) { if (idx>max) max=idx; v[idx] = t; return idx++; }
         throw "ERR: List full";
     }
 #else
     T   pop()     { return v[--idx]; }
-    int push(T t) { v[max=idx] = t; return idx++; }
+    int push(T t) { if (idx>max) max=idx; v[idx] = t; return idx++; }
 #endif // RANGE_CHECK
     void push(T *a, int n)  { for (int i=0; i<n; i++) push(*(a+i)); }
 //    void merge(List& a)     { for (int i=0; i<a.idx; i++) push(a[i]);}
@@ -49,6 +49,8 @@ typedef void (*fop)(Thread&); /// opcode function pointer
 #define FORTH_FUNC  0x20
 #define JAVA_FUNC   0x40
 #define IMMD_FLAG   0x80
+#define STATIC_FLAG 0x04      /** static field or method (ftype) */
+#define SYNC_FLAG   0x10      /** synchronized method (ftype) */
 struct Method {
     const char *name = 0;     /// for debugging, TODO (in const_pool)
 #if METHOD_PACKED
@@ -71,15 +73,26 @@ struct Method {
 /// Word - shared struct for Class and Method
 ///   class list - linked list of words, dict[cls_root], pfa => next_class
 ///   vtable     - linked list of words, dict[class.pfa], pfa => next_method
+///   vtx        - indexed vtable, dict[class.pfa] => [n, mx0, mx1, ...]
+///   fields     - linked list of words, dict[class.pfa], pfa => [offset, type]
+///                instance offsets continue from the super class, packed by size
+///                inherited slots first, overrides replace them in place
 ///
-#define PFA_CLS_SUPR    0    /** super class            */
-#define PFA_CLS_JDX     2    /** java class file index  */
-#define PFA_CLS_VT      4    /** java virtual table     */
-#define PFA_CLS_CVSZ    6    /** class variable count   */
-#define PFA_CLS_IVSZ    8    /** instance var count     */
-#define PFA_CLS_CV      10   /** class variable storage */
+#define PFA_CLS_SUPR    0                  /** super class            */
+#define PFA_CLS_JDX     (sizeof(IU))       /** java class file index  */
+#define PFA_CLS_VT      (sizeof(IU)*2)     /** java virtual table     */
+#define PFA_CLS_CVSZ    (sizeof(IU)*3)     /** class variable count   */
+#define PFA_CLS_IVSZ    (sizeof(IU)*4)     /** instance var count     */
+#define PFA_CLS_VTX     (sizeof(IU)*5)     /** indexed vtable (pmem index) */
+#define PFA_CLS_FLD     (sizeof(IU)*6)     /** field list             */
+#define PFA_CLS_LOCK    (sizeof(IU)*7)     /** lock word of static synchronized methods */
+#define PFA_CLS_CV      (PFA_CLS_LOCK + sizeof(DU))  /** class variable storage */
+#define PFA_FLD_OFF     0                  /** field storage offset (bytes) */
+#define PFA_FLD_TYPE    (sizeof(IU))       /** field type descriptor  */
 #define PFA_PARM_IDX    sizeof(PU)
-struct Word {                /// 4-byte header
+#define PFA_VT_SLOT     (sizeof(PU) + sizeof(IU))    /** slot in indexed vtable */
+#define PFA_JAVA_JDX    (sizeof(PU) + sizeof(IU)*2)  /** java class file index  */
+struct Word {                /// 4-byte header, 6 with 32-bit IU
     IU  lfa;                 /// link field to previous word
     U8  len;                 /// name of method
 
@@ -0,0 +1,204 @@
+///
+/// @brief nanoJVM job executor, workers with spare VMs and work stealing
+///
+#if !ARDUINO
+#include <deque>
+#include <thread>
+#include <chrono>
+#include <unistd.h>     // access
+#include "exec.h"
+#include "forth.h"      // forth_setup
+#include "java.h"       // java_setup, java_load
+#include "thread.h"     // Thread, gVM
+#include "task.h"       // task_join_all
+
+using namespace std;
+
+static U64 now_ns() {
+    return chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+}
+///
+/// VM of a job, console output collected for the future
+///
+struct JobVM : VM {
+    string out;
+};
+static void job_con(int, const char *msg) { static_cast<JobVM*>(gVM)->out += msg; }
+
+struct Job {
+    string cls;                   /// class files, comma separated
+    string method;                /// entry method
+    promise<JobResult> p;
+};
+struct Worker {
+    Executor     *ex;
+    int          id;
+    mutex        mx;              /// guards q and st
+    deque<Job>   q;               /// own jobs, oldest first
+    ExecStat     st;
+    JobVM        *vm = 0;         /// spare, set up for the next job
+    thread       th;
+
+    void spare();                 /// set up a fresh VM
+    bool take(Job &j, bool &stolen);
+    void run(Job &j, bool stolen);
+    void loop();
+};
+
+void Worker::spare() {
+    U64 t = now_ns();
+    delete vm;
+    vm = new JobVM;
+    vm_use(vm);
+    forth_setup(job_con);
+    java_setup(job_con);
+    vm_use(0);
+    lock_guard<mutex> lk(mx);
+    st.setup_ns += now_ns() - t;
+}
+///
+/// oldest job of own deque, else newest of the next non-empty one
+///
+bool Worker::take(Job &j, bool &stolen) {
+    for (int k = 0; k < ex->n; k++) {
+        Worker &v = ex->w[(id + k) % ex->n];
+        unique_lock<mutex> lk(v.mx);
+        if (v.q.empty()) continue;
+        if (k) { j = move(v.q.back());  v.q.pop_back();  }
+        else   { j = move(v.q.front()); v.q.pop_front(); }
+        lk.unlock();
+        stolen = k != 0;
+        lock_guard<mutex> g(ex->mx);
+        ex->pending--;
+        return true;
+    }
+    return false;
+}
+void Worker::run(Job &j, bool stolen) {
+    JobResult r;
+    r.worker = id;
+    U64 t = now_ns();
+    vm_use(vm);
+    try {
+        for (size_t b = 0; !r.rc && b <= j.cls.size(); ) {
+            size_t e = j.cls.find(',', b);
+            if (e == string::npos) e = j.cls.size();
+            string f = j.cls.substr(b, e - b);
+            b = e + 1;
+            if (access(f.c_str(), R_OK) || !java_load(f.c_str())) {
+                r.rc  = EXEC_ERR_LOAD;
+                r.err = "failed to load " + f;
+            }
+        }
+        IU mx = r.rc ? DATA_NA : gPool.get_method(j.method.c_str());
+        if (!r.rc && mx == DATA_NA) {
+            r.rc  = EXEC_ERR_METHOD;
+            r.err = "no method " + j.method;
+        }
+        if (!r.rc) {
+            gT0.init(Loader::active());
+            int s = gT0.ss.idx;
+            gT0.dispatch(mx);
+            task_join_all();             /// threads the job started
+            if (gT0.ss.idx > s) r.ret = gT0.TOS;
+        }
+    }
+    catch (const char *e) {
+        r.rc  = EXEC_ERR_RUN;
+        r.err = e;
+        try { task_join_all(); }         /// threads started before the error, and
+        catch (const char *) {}          /// the VM lock, before spare() drops the VM
+    }
+    r.out = vm->out + vm->jout.str();    /// print() without a newline
+    vm_use(0);
+    {
+        lock_guard<mutex> lk(mx);
+        st.jobs++;
+        st.stolen  += stolen;
+        st.failed  += r.rc != EXEC_OK;
+        st.busy_ns += now_ns() - t;
+    }
+    j.p.set_value(move(r));
+}
+void Worker::loop() {
+    spare();
+    for (;;) {
+        Job  j;
+        bool stolen;
+        if (take(j, stolen)) {
+            run(j, stolen);
+            spare();                     /// used VM is dropped
+            continue;
+        }
+        unique_lock<mutex> lk(ex->mx);
+        ex->cv.wait(lk, [this]{ return ex->pending || ex->stop; });
+        if (!ex->pending) break;         /// stopped, nothing left
+    }
+    delete vm;
+    vm = 0;
+}
+///
+/// Executor
+///
+Executor::Executor(int nworker) {
+    n  = nworker > 0 ? nworker : (int)thread::hardware_concurrency();
+    if (n < 1) n = 1;
+    w  = new Worker[n];
+    t0 = now_ns();
+    for (int i = 0; i < n; i++) {
+        w[i].ex = this;
+        w[i].id = i;
+        w[i].th = thread(&Worker::loop, &w[i]);
+    }
+}
+Executor::~Executor() {
+    {
+        lock_guard<mutex> lk(mx);
+        stop = true;
+    }
+    cv.notify_all();
+    for (int i = 0; i < n; i++) w[i].th.join();
+    delete[] w;
+}
+future<JobResult> Executor::submit(const char *cls, const char *method) {
+    Job j;
+    j.cls    = cls;
+    j.method = method;
+    future<JobResult> f = j.p.get_future();
+    U32 k;
+    {
+        lock_guard<mutex> lk(mx);
+        k = next++ % n;
+    }
+    {
+        lock_guard<mutex> lk(w[k].mx);
+        w[k].q.push_back(move(j));
+    }
+    {
+        lock_guard<mutex> lk(mx);
+        pending++;
+    }
+    cv.notify_one();
+    return f;
+}
+ExecStat Executor::stat(int i) {
+    lock_guard<mutex> lk(w[i].mx);
+    return w[i].st;
+}
+void Executor::dump() {
+    double s = (now_ns() - t0) * 1e-9;
+    U32    jobs = 0;
+    LOG("\nexec: "); LOU(n); LOG(" workers");
+    for (int i = 0; i < n; i++) {
+        ExecStat x = stat(i);
+        jobs += x.jobs;
+        LOG("\n  ["); LOU(i); LOG("] jobs="); LOU(x.jobs);
+        LOG(" stolen="); LOU(x.stolen); LOG(" failed="); LOU(x.failed);
+        LOG(" busy="); LOU(s > 0 ? (U32)(x.busy_ns * 1e-7 / s) : 0); LOG("%");
+        LOG(" jobs/s="); LOU((U32)(s > 0 ? x.jobs / s : 0));
+        LOG(" setup_us="); LOU((U32)(x.setup_ns / 1000 / (x.jobs + 1)));
+    }
+    LOG("\n  total jobs/s="); LOU((U32)(s > 0 ? jobs / s : 0)); LOG("\n");
+}
+#endif // !ARDUINO
@@ -0,0 +1,66 @@
+///
+/// @brief nanoJVM job executor, many small Java jobs in one process (host)
+/// Note:
+///   * a pool of workers, each a native thread holding a spare VM with
+///     forth_setup/java_setup done, a job runs in the spare and the worker
+///     sets up the next one right after, i.e. before taking another job
+///   * a job is one or more class files (comma separated, loaded in order)
+///     and an entry method of the last one, static and without arguments
+///   * submit() queues round-robin onto per-worker deques, a worker takes
+///     the oldest job of its own deque and, when empty, steals the newest
+///     of another, idle workers sleep until the next submit
+///   * the future carries the jout output, the value left by the entry
+///     method (int return) and an error code
+///   * java/lang/Thread started by a job runs in the job's VM, the job is
+///     done when all of them finished
+///
+#ifndef NANOJVM_EXEC_H
+#define NANOJVM_EXEC_H
+#include <string>
+#include <future>
+#include <mutex>
+#include <condition_variable>
+#include "common.h"
+
+#define EXEC_OK         0
+#define EXEC_ERR_LOAD   1         /** class file failed to load   */
+#define EXEC_ERR_METHOD 2         /** entry method not found      */
+#define EXEC_ERR_RUN    3         /** VM error while running      */
+
+struct JobResult {
+    int         rc  = EXEC_OK;    /// EXEC_OK or EXEC_ERR_*
+    DU          ret = 0;          /// value returned by the entry method
+    std::string out;              /// captured jout
+    std::string err;              /// error message, rc != EXEC_OK
+    int         worker = -1;      /// worker that ran the job
+};
+struct ExecStat {
+    U32  jobs     = 0;            /// jobs run
+    U32  stolen   = 0;            /// of which taken from another worker
+    U32  failed   = 0;            /// of which rc != EXEC_OK
+    U64  busy_ns  = 0;            /// time in jobs
+    U64  setup_ns = 0;            /// time setting up spare VMs
+};
+struct Worker;
+
+struct Executor {
+    Executor(int nworker=0);      /// 0: one per core
+    ~Executor();                  /// runs what is queued, then joins workers
+
+    std::future<JobResult> submit(const char *cls, const char *method="main");
+    int      size() { return n; }
+    ExecStat stat(int w);         /// statistics of worker w
+    void     dump();              /// per-worker jobs, steals, busy time and jobs/s
+
+private:
+    Worker   *w;
+    int      n;
+    U64      t0;                  /// creation time, for jobs/s
+    U32      next    = 0;         /// round-robin submit
+    std::mutex              mx;   /// guards pending, stop and next
+    std::condition_variable cv;   /// idle workers wait for pending
+    int      pending = 0;         /// jobs queued, not yet taken
+    bool     stop    = false;     /// workers exit once nothing is pending
+    friend   struct Worker;
+};
+#endif // NANOJVM_EXEC_H
@@ -0,0 +1,310 @@
+///
+/// @brief nanoJVM direct-threaded engine (GCC labels-as-values)
+/// Note:
+///   * hot opcodes run inline in one function, no per-op function call
+///   * operand stack kept in memory with top at ss.v[ss.idx], sp held in register
+///   * everything else falls back to the microcode ROM (reference engine)
+///   * time slice charged on backward branches by loop body size (bytes)
+///
+#include "ucode.h"
+
+#if CGOTO_ENGINE
+extern Ucode uCode;
+///
+/// macros for reduce verbosity
+///
+#define NEXT          goto *jt[op = *pc++]
+#define PUSH(n)       { *++sp = (DU)(n); if (sp > hi) hi = sp; }
+#define POP()         (*sp--)
+#define TOP           (*sp)
+#define NOS           (*(sp - 1))
+#define S16P(p)       ((S16)(((U16)(p)[0] << 8) | (p)[1]))
+#define IVP(ox)       (OBJ(ox)->data + (U16)S16P(pc))   /** quickened field address */
+#define JMP()         { S16 o = S16P(pc); if (o < 0) TICK(-o); pc += o - 1; }
+#define CJMP(f)       { if (f) JMP() else pc += sizeof(U16); }
+#define ALU(op)       { DU n = POP(); TOP op n; NEXT; }
+#define IF(cmp)       { DU n = POP(); CJMP(n cmp 0); NEXT; }
+#define IF_ICMP(cmp)  { DU n = POP(); DU m = POP(); CJMP(m cmp n); NEXT; }
+///
+/// long in two cells, low first, i.e. high cell on top
+///
+#define L64(p)        ((S64)(((U64)(U32)(p)[1] << 32) | (U32)(p)[0]))
+#define SET64(p, v)   { S64 _v = (v); (p)[0] = (DU)_v; (p)[1] = (DU)(_v >> 32); }
+#define LALU(op)      { S64 n = L64(sp - 1); sp -= 2; SET64(sp - 1, L64(sp - 1) op n); NEXT; }
+///
+/// float in one cell, double in two (bit patterns), host FPU
+///
+#define FALU(op)      { F32 n = bitsf(POP()); TOP = fbits(bitsf(TOP) op n); NEXT; }
+#define D64(p)        bitsd(L64(p))
+#define DALU(op)      { F64 n = D64(sp - 1); sp -= 2; SET64(sp - 1, dbits(D64(sp - 1) op n)); NEXT; }
+#define FCMP(m,n,nan) ((m) > (n) ? 1 : (m) == (n) ? 0 : (m) < (n) ? -1 : (nan))
+///
+/// sync register state back to/from Thread (for microcode and calls)
+///   hi, the stack high water since SYNC_IN, is folded into ss.max as List::push does
+///
+#define SYNC_OUT()    { IP = (IU)(pc - J0); ss.idx = (int)(sp - ss.v); TOS = *sp; \
+                        if (hi - ss.v > ss.max) ss.max = (int)(hi - ss.v); }
+#define SYNC_IN()     { pc = J0 + IP; sp = hi = ss.v + ss.idx; *sp = TOS; }
+///
+/// charge time slice, stack synced while other threads run (gc scans it)
+///
+#define TICK(n)       { icnt += (n); if ((budget -= (n)) <= 0) { SYNC_OUT(); preempt(); SYNC_IN(); } }
+
+void Thread::java_fast(IU j, U16 nparm) {
+    static void *jt[256] = { 0 };      /// dispatch table of labels, shared by all VMs
+    static int  jt_ok    = 0;          /// 0: empty, 1: being filled, 2: ready
+    if (__atomic_load_n(&jt_ok, __ATOMIC_ACQUIRE) != 2) {
+        int e = 0;
+        if (__atomic_compare_exchange_n(&jt_ok, &e, 1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+            for (int i=0; i<256; i++) jt[i] = &&L_slow;
+            jt[0x00] = &&L_nop;
+            jt[0x01] = &&L_iconst_0;
+            jt[0x02] = &&L_iconst_m1;
+            jt[0x03] = &&L_iconst_0;  jt[0x04] = &&L_iconst_1;
+            jt[0x05] = &&L_iconst_2;  jt[0x06] = &&L_iconst_3;
+            jt[0x07] = &&L_iconst_4;  jt[0x08] = &&L_iconst_5;
+            jt[0x09] = &&L_lconst_0;  jt[0x0a] = &&L_lconst_1;
+            jt[0x0b] = &&L_iconst_0;  jt[0x0e] = &&L_lconst_0;  /// +0.0f, +0.0 are all zero bits
+            jt[0x10] = &&L_bipush;    jt[0x11] = &&L_sipush;
+            jt[0x12] = &&L_ldc;
+            jt[0x15] = &&L_load;      jt[0x19] = &&L_load;
+            jt[0x1a] = &&L_load_0;    jt[0x1b] = &&L_load_1;
+            jt[0x1c] = &&L_load_2;    jt[0x1d] = &&L_load_3;
+            jt[0x16] = &&L_lload;     jt[0x37] = &&L_lstore;
+            jt[0x18] = &&L_lload;     jt[0x39] = &&L_lstore;    /// double as long
+            jt[0x1e] = jt[0x1f] = jt[0x20] = jt[0x21] = &&L_lload_n;
+            jt[0x26] = jt[0x27] = jt[0x28] = jt[0x29] = &&L_lload_n;
+            jt[0x3f] = jt[0x40] = jt[0x41] = jt[0x42] = &&L_lstore_n;
+            jt[0x47] = jt[0x48] = jt[0x49] = jt[0x4a] = &&L_lstore_n;
+            jt[0x17] = &&L_load;      jt[0x38] = &&L_store;     /// float as int
+            jt[0x22] = &&L_load_0;    jt[0x23] = &&L_load_1;
+            jt[0x24] = &&L_load_2;    jt[0x25] = &&L_load_3;
+            jt[0x43] = &&L_store_0;   jt[0x44] = &&L_store_1;
+            jt[0x45] = &&L_store_2;   jt[0x46] = &&L_store_3;
+            jt[0x30] = &&L_iaload;    jt[0x51] = &&L_iastore;
+            jt[0x2a] = &&L_load_0;    jt[0x2b] = &&L_load_1;
+            jt[0x2c] = &&L_load_2;    jt[0x2d] = &&L_load_3;
+            jt[0x2e] = &&L_iaload;    jt[0x32] = &&L_iaload;
+            jt[0x36] = &&L_store;     jt[0x3a] = &&L_store;
+            jt[0x3b] = &&L_store_0;   jt[0x3c] = &&L_store_1;
+            jt[0x3d] = &&L_store_2;   jt[0x3e] = &&L_store_3;
+            jt[0x4b] = &&L_store_0;   jt[0x4c] = &&L_store_1;
+            jt[0x4d] = &&L_store_2;   jt[0x4e] = &&L_store_3;
+            jt[0x4f] = &&L_iastore;   jt[0x53] = &&L_iastore;
+            jt[0x33] = &&L_baload;    jt[0x34] = &&L_caload;    jt[0x35] = &&L_saload;
+            jt[0x54] = &&L_bastore;   jt[0x55] = &&L_castore;   jt[0x56] = &&L_castore;   /// short store == char store
+            jt[0x57] = &&L_pop;       jt[0x58] = &&L_pop2;
+            jt[0x59] = &&L_dup;
+            jt[0x60] = &&L_iadd;      jt[0x64] = &&L_isub;
+            jt[0x68] = &&L_imul;      jt[0x6c] = &&L_idiv;
+            jt[0x70] = &&L_irem;      jt[0x74] = &&L_ineg;
+            jt[0x78] = &&L_ishl;      jt[0x7a] = &&L_ishr;
+            jt[0x7c] = &&L_iushr;     jt[0x7e] = &&L_iand;
+            jt[0x80] = &&L_ior;       jt[0x82] = &&L_ixor;
+            jt[0x84] = &&L_iinc;
+            jt[0x61] = &&L_ladd;      jt[0x65] = &&L_lsub;
+            jt[0x69] = &&L_lmul;      jt[0x7f] = &&L_land;
+            jt[0x81] = &&L_lor;       jt[0x83] = &&L_lxor;
+            jt[0x85] = &&L_i2l;       jt[0x88] = &&L_l2i;
+            jt[0x94] = &&L_lcmp;
+            jt[0x62] = &&L_fadd;      jt[0x66] = &&L_fsub;
+            jt[0x6a] = &&L_fmul;      jt[0x6e] = &&L_fdiv;
+            jt[0x76] = &&L_fneg;
+            jt[0x63] = &&L_dadd;      jt[0x67] = &&L_dsub;
+            jt[0x6b] = &&L_dmul;      jt[0x6f] = &&L_ddiv;
+            jt[0x77] = &&L_dneg;
+            jt[0x86] = &&L_i2f;       jt[0x8b] = &&L_f2i;
+            jt[0x87] = &&L_i2d;       jt[0x8e] = &&L_d2i;
+            jt[0x8d] = &&L_f2d;       jt[0x90] = &&L_d2f;
+            jt[0x95] = &&L_fcmpl;     jt[0x96] = &&L_fcmpg;
+            jt[0x97] = &&L_dcmpl;     jt[0x98] = &&L_dcmpg;
+            jt[0x91] = &&L_i2b;       jt[0x92] = &&L_i2c;
+            jt[0x93] = &&L_i2s;
+            jt[0x99] = &&L_ifeq;      jt[0x9a] = &&L_ifne;
+            jt[0x9b] = &&L_iflt;      jt[0x9c] = &&L_ifge;
+            jt[0x9d] = &&L_ifgt;      jt[0x9e] = &&L_ifle;
+            jt[0x9f] = &&L_if_icmpeq; jt[0xa0] = &&L_if_icmpne;
+            jt[0xa1] = &&L_if_icmplt; jt[0xa2] = &&L_if_icmpge;
+            jt[0xa3] = &&L_if_icmpgt; jt[0xa4] = &&L_if_icmple;
+            jt[0xa7] = &&L_goto;
+            jt[0xac] = &&L_return;    jt[0xb0] = &&L_return;
+            jt[0xad] = &&L_return;    jt[0xb1] = &&L_return;
+            jt[0xae] = &&L_return;    jt[0xaf] = &&L_return;
+            jt[0xbe] = &&L_arraylength;
+            jt[0xc6] = &&L_ifnull;    jt[0xc7] = &&L_ifnonnull;
+            jt[OP_GETSTATIC_Q] = &&L_getstatic_q;
+            jt[OP_PUTSTATIC_Q] = &&L_putstatic_q;
+            jt[OP_GETFIELD_Q]  = &&L_getfield_q;
+            jt[OP_PUTFIELD_Q]  = &&L_putfield_q;
+            jt[OP_GETFIELD_B]  = &&L_getfield_b;
+            jt[OP_GETFIELD_C]  = &&L_getfield_c;
+            jt[OP_GETFIELD_S]  = &&L_getfield_s;
+            jt[OP_PUTFIELD_B]  = &&L_putfield_b;
+            jt[OP_PUTFIELD_S]  = &&L_putfield_s;
+            __atomic_store_n(&jt_ok, 2, __ATOMIC_RELEASE);
+        }
+        else while (__atomic_load_n(&jt_ok, __ATOMIC_ACQUIRE) != 2) yield();  /// filled by another VM
+    }
+#if RANGE_CHECK
+    if (ss.idx + J->getU16(j - 8) + J->getU16(j - 6) >= SS_SZ) { /// max_stack + max_locals
+        throw "ERR: java_fast stack overflow";
+    }
+#endif // RANGE_CHECK
+    frame_in(j, nparm);
+
+    U8 *J0 = J->image();                /// class file image
+    U8 *pc;                             /// program counter (in image)
+    DU *sp;                             /// top of stack (in ss.v)
+    DU *hi;                             /// highest sp since SYNC_IN
+    DU *lv = ss.v + SP;                 /// local variables
+    U8 op;                              /// current opcode
+    SYNC_IN();
+    NEXT;
+    ///
+    /// constants
+    ///
+L_nop:        NEXT;
+L_iconst_m1:  PUSH(-1); NEXT;
+L_iconst_0:   PUSH(0);  NEXT;
+L_iconst_1:   PUSH(1);  NEXT;
+L_iconst_2:   PUSH(2);  NEXT;
+L_iconst_3:   PUSH(3);  NEXT;
+L_iconst_4:   PUSH(4);  NEXT;
+L_iconst_5:   PUSH(5);  NEXT;
+L_bipush:     PUSH((S8)*pc++); NEXT;
+L_sipush:     PUSH(S16P(pc)); pc += 2; NEXT;
+L_ldc:        PUSH(ldc(*pc++)); NEXT;              /// int/float value, else constant index
+    ///
+    /// local variables
+    ///
+L_load:       PUSH(lv[*pc++]); NEXT;
+L_load_0:     PUSH(lv[0]); NEXT;
+L_load_1:     PUSH(lv[1]); NEXT;
+L_load_2:     PUSH(lv[2]); NEXT;
+L_load_3:     PUSH(lv[3]); NEXT;
+L_store:      lv[*pc++] = POP(); NEXT;
+L_store_0:    lv[0] = POP(); NEXT;
+L_store_1:    lv[1] = POP(); NEXT;
+L_store_2:    lv[2] = POP(); NEXT;
+L_store_3:    lv[3] = POP(); NEXT;
+L_iinc:       lv[pc[0]] += (S8)pc[1]; pc += 2; NEXT;
+L_lload:      { DU *p = lv + *pc++; PUSH(p[0]); PUSH(p[1]); NEXT; }
+L_lload_n:    { DU *p = lv + ((op - 0x1e) & 3); PUSH(p[0]); PUSH(p[1]); NEXT; }   /// lload_n, dload_n
+L_lstore:     { DU *p = lv + *pc++; p[1] = POP(); p[0] = POP(); NEXT; }
+L_lstore_n:   { DU *p = lv + ((op - 0x3f) & 3); p[1] = POP(); p[0] = POP(); NEXT; } /// lstore_n, dstore_n
+    ///
+    /// arrays
+    ///
+L_iaload:     { DU i = POP(); TOP = aget<DU>((IU)TOP, (IU)i); NEXT; }
+L_baload:     { DU i = POP(); TOP = aget<S8>((IU)TOP, (IU)i); NEXT; }
+L_caload:     { DU i = POP(); TOP = aget<U16>((IU)TOP, (IU)i); NEXT; }
+L_saload:     { DU i = POP(); TOP = aget<S16>((IU)TOP, (IU)i); NEXT; }
+L_iastore:    { DU v = POP(); DU i = POP(); aput<DU>((IU)POP(), (IU)i, v); NEXT; }
+L_bastore:    { DU v = POP(); DU i = POP(); aput<S8>((IU)POP(), (IU)i, (S8)v); NEXT; }
+L_castore:    { DU v = POP(); DU i = POP(); aput<U16>((IU)POP(), (IU)i, (U16)v); NEXT; }
+L_arraylength: TOP = alen((IU)TOP); NEXT;
+    ///
+    /// stack ops
+    ///
+L_pop:        sp--;    NEXT;
+L_pop2:       sp -= 2; NEXT;
+L_dup:        { DU n = TOP; PUSH(n); NEXT; }
+    ///
+    /// ALU
+    ///
+L_iadd:       ALU(+=);
+L_isub:       ALU(-=);
+L_imul:       ALU(*=);
+L_idiv:       { DU n = POP(); TOP = n == -1 ? (DU)(0U - (U32)TOP) : TOP / n; NEXT; }
+L_irem:       { DU n = POP(); TOP = n == -1 ? 0 : TOP % n; NEXT; }
+L_ineg:       TOP = (DU)(0U - (U32)TOP); NEXT;
+L_ishl:       { DU n = POP(); TOP = (DU)((U32)TOP << (n & 31)); NEXT; }
+L_ishr:       { DU n = POP(); TOP >>= n & 31; NEXT; }
+L_iushr:      { DU n = POP(); TOP = (DU)((U32)TOP >> (n & 31)); NEXT; }
+L_iand:       ALU(&=);
+L_ior:        ALU(|=);
+L_ixor:       ALU(^=);
+L_i2b:        TOP = (S8)TOP;  NEXT;
+L_i2c:        TOP = (U16)TOP; NEXT;
+L_i2s:        TOP = (S16)TOP; NEXT;
+    ///
+    /// long ALU, shifts, ldiv/lrem and long arrays go through microcode
+    ///
+L_lconst_0:   PUSH(0); PUSH(0); NEXT;
+L_lconst_1:   PUSH(1); PUSH(0); NEXT;
+L_ladd:       LALU(+);
+L_lsub:       LALU(-);
+L_lmul:       LALU(*);
+L_land:       LALU(&);
+L_lor:        LALU(|);
+L_lxor:       LALU(^);
+L_i2l:        { DU n = TOP; PUSH(n >> 31); NEXT; }
+L_l2i:        sp--; NEXT;
+L_lcmp:       { S64 n = L64(sp - 1); sp -= 2; S64 m = L64(sp - 1); sp--; TOP = (m > n) - (m < n); NEXT; }
+    ///
+    /// float/double ALU, frem/drem, long conversions and arrays go through microcode
+    ///
+L_fadd:       FALU(+);
+L_fsub:       FALU(-);
+L_fmul:       FALU(*);
+L_fdiv:       FALU(/);
+L_fneg:       TOP = fbits(-bitsf(TOP)); NEXT;
+L_dadd:       DALU(+);
+L_dsub:       DALU(-);
+L_dmul:       DALU(*);
+L_ddiv:       DALU(/);
+L_dneg:       SET64(sp - 1, dbits(-D64(sp - 1))); NEXT;
+L_i2f:        TOP = fbits((F32)TOP); NEXT;
+L_f2i:        TOP = f2i(bitsf(TOP)); NEXT;
+L_i2d:        { F64 v = TOP; PUSH(0); SET64(sp - 1, dbits(v)); NEXT; }
+L_d2i:        { F64 v = D64(sp - 1); sp--; TOP = f2i(v); NEXT; }
+L_f2d:        { F64 v = bitsf(TOP); PUSH(0); SET64(sp - 1, dbits(v)); NEXT; }
+L_d2f:        { F32 v = (F32)D64(sp - 1); sp--; TOP = fbits(v); NEXT; }
+L_fcmpl:      { F32 n = bitsf(POP()); F32 m = bitsf(TOP); TOP = FCMP(m, n, -1); NEXT; }
+L_fcmpg:      { F32 n = bitsf(POP()); F32 m = bitsf(TOP); TOP = FCMP(m, n, 1);  NEXT; }
+L_dcmpl:      { F64 n = D64(sp - 1); sp -= 2; F64 m = D64(sp - 1); sp--; TOP = FCMP(m, n, -1); NEXT; }
+L_dcmpg:      { F64 n = D64(sp - 1); sp -= 2; F64 m = D64(sp - 1); sp--; TOP = FCMP(m, n, 1);  NEXT; }
+    ///
+    /// branching
+    ///
+L_ifeq:       IF(==);
+L_ifne:       IF(!=);
+L_iflt:       IF(<);
+L_ifge:       IF(>=);
+L_ifgt:       IF(>);
+L_ifle:       IF(<=);
+L_if_icmpeq:  IF_ICMP(==);
+L_if_icmpne:  IF_ICMP(!=);
+L_if_icmplt:  IF_ICMP(<);
+L_if_icmpge:  IF_ICMP(>=);
+L_if_icmpgt:  IF_ICMP(>);
+L_if_icmple:  IF_ICMP(<=);
+L_ifnull:     IF(==);
+L_ifnonnull:  IF(!=);
+L_goto:       JMP(); NEXT;
+    ///
+    /// quickened field access
+    ///
+L_getstatic_q: PUSH(*(DU*)&gPool.pmem.v[(U16)S16P(pc)]); pc += 2; NEXT;
+L_putstatic_q: *(DU*)&gPool.pmem.v[(U16)S16P(pc)] = POP(); pc += 2; NEXT;
+L_getfield_q:  TOP = *(DU*)IVP((IU)TOP);  pc += 2; NEXT;
+L_getfield_b:  TOP = *(S8*)IVP((IU)TOP);  pc += 2; NEXT;
+L_getfield_c:  TOP = *(U16*)IVP((IU)TOP); pc += 2; NEXT;
+L_getfield_s:  TOP = *(S16*)IVP((IU)TOP); pc += 2; NEXT;
+L_putfield_q:  { DU v = POP(); *(DU*)IVP((IU)POP())  = v;      pc += 2; NEXT; }
+L_putfield_b:  { DU v = POP(); *(S8*)IVP((IU)POP())  = (S8)v;  pc += 2; NEXT; }
+L_putfield_s:  { DU v = POP(); *(S16*)IVP((IU)POP()) = (S16)v; pc += 2; NEXT; }
+    ///
+    /// everything else (invoke, new, wide, ...) through microcode ROM
+    ///
+L_slow:
+    SYNC_OUT();
+    uCode.exec(*this, op);
+    if (!IP) { frame_out(op); return; } /// returned from microcode
+    SYNC_IN();
+    NEXT;
+L_return:
+    SYNC_OUT();
+    frame_out(op);
+}
+#endif // CGOTO_ENGINE
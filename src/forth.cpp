@@ -1,4 +1,8 @@
 #include "forth.h"  // Forth outer interpreter (include mmu.h, ucode.h, thread.h)
+#include "trace.h"  // execution tracer
+#include "profile.h" // execution profiler
+#include "gc.h"     // garbage collector
+#include "task.h"   // threads, delay
 
 #define CELL(a)     (*(DU*)(t.M0 + a))   /** fetch a cell from parameter memory */
 #define CODE(s, g)  { s, [](Thread &t){ g; }, ACL_BUILTIN }
@@ -40,10 +44,17 @@ static Method _word[] = {
     CODE("here",  PUSH(gPool.pmem.idx)),
     CODE("words", words(t)),
     CODE("ss",    ss_dump(t)),
+    CODE("trace", gTrace.level = (U8)POP),       // n -- (0:off, 1:calls, 2:instructions, 3:stack)
+    CODE("tdump", gTrace.dump(); gTrace.clear()),
+    CODE("profile",                              // n -- (0:off, 1:clear and on, 2:report)
+         DU n = POP; if (n==2) gProf.dump(); else { if (n) gProf.clear(); gProf.on = n; }),
+    CODE("gc",    gGC.collect()),                 // -- collect object heap now
+    CODE("gcstat", gGC.dump()),                  // -- heap occupancy and pause times
     CODE("dump",  DU n = POP; IU a = POP; mem_dump(t, a, n)),
     CODE("tick",  IU w = gPool.get_method(next_word()); PUSH(w)),
     CODE("clock", PUSH(millis())),
-    CODE("delay", delay(POP)),
+    CODE("delay", task_sleep(POP)),
+    CODE("quantum", gVM->quantum = POP),          // n -- set opcodes per time slice
     CODE("interpreter", forth_interpreter(t)),
     CODE("bye",   exit(0))
     /// @}
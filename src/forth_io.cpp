@@ -6,13 +6,12 @@
 
 using namespace std;    // default to C++ standard template library
 ///
-/// JVM streaming IO
+/// JVM streaming IO, per VM
 ///
-istringstream   fin;                    /// forth_in
-ostringstream   fout;                   /// forth_out
-string          tib;                    /// terminal input buffer
-void send_to_con(int len, const char *msg) { LOG(msg); }
-void (*fout_cb)(int, const char*) = send_to_con;      /// forth output callback function
+#define fin     (gVM->fin)              /** forth_in                */
+#define fout    (gVM->fout)             /** forth_out               */
+#define tib     (gVM->tib)              /** terminal input buffer   */
+#define fout_cb (gVM->fout_cb)          /** forth output callback function */
 
 #define ENDL    endl; fout_cb(fout.str().length(), fout.str().c_str()); fout.str("")
 ///
@@ -80,7 +79,7 @@ char *scan(char c) {
 int handle_number(Thread &t, const char *idiom) {
     char *p;
     int n = static_cast<int>(strtol(idiom, &p, t.base));
-    LOX(n); LOG("\n");
+    DLOX(n); DLOG("\n");
     if (*p != '\0') {        /// * not number
         t.compile = false;   ///> reset to interpreter mode
         return -1;           ///> skip the entire input buffer
@@ -102,11 +101,11 @@ void forth_outer(Thread &t, const char *cmd) {
     fout.str("");                            /// clean output buffer, ready for next
     while (fin >> tib) {
         const char *idiom = tib.c_str();
-        LOG(idiom); LOG("=>");
+        DLOG(idiom); DLOG("=>");
         IU m = gPool.get_method(idiom, t.ctx);    /// search for word in current context
         if (m != DATA_NA) {					 ///> if handle method found
             Word *w = WORD(m);
-            LOG(w->nfa()); LOG(" 0x"); LOX(m);
+            DLOG(w->nfa()); DLOG(" 0x"); DLOX(m);
             if (t.compile && !w->immd) {     /// * in compile mode?
                 gPool.mem_iu(m);             /// * add found word to new colon word
             }
@@ -117,7 +116,7 @@ void forth_outer(Thread &t, const char *cmd) {
         if (m != DATA_NA) {                  ///
             Word *w  = WORD(m);              /// switch vocabulary
             IU   jcf = *(IU*)w->pfa(PFA_CLS_JDX);
-            LOG("class "); LOG(w->nfa()); LOG(" 0x"); LOX(m); ("\n");
+            DLOG("class "); DLOG(w->nfa()); DLOG(" 0x"); DLOX(m); DLOG("\n");
             t.init((int)jcf);
         }
         else if (handle_number(t, idiom)) {	 ///> try as a number
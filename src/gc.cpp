@@ -0,0 +1,317 @@
+#include "gc.h"
+#include "thread.h"     // Thread, gPool, OBJ
+#include "profile.h"    // Profiler::clock
+
+#define BIT(a)          ((a) / sizeof(DU))
+#define FLD_REF(t)      ((t)==TYPE_OBJ || (t)==TYPE_ARRAY)
+#define FLD_STATIC(w)   ((w)->ftype & (STATIC_FLAG >> 2))   /** STATIC_FLAG sits in ftype */
+
+void GC::attach(Thread &t) {
+    for (int i = 0; i < nthr; i++) if (thr[i] == &t) return;
+    if (nthr == GC_ROOT_SZ) throw "ERR: gc root threads full";
+    thr[nthr++] = &t;
+}
+void GC::detach(Thread &t) {
+    gPool.tlab_retire(t.tlab);
+    for (int i = 0; i < nthr; i++) {
+        if (thr[i] == &t) { thr[i] = thr[--nthr]; return; }
+    }
+}
+///
+/// a cell refers to an object only when it hits an object start
+///
+bool GC::is_obj(DU a) {
+    U32 x = (U32)a;
+    if (x < OBJ0 || x >= (U32)gPool.heap.idx || (x & (sizeof(DU) - 1))) return false;
+    return (start[BIT(x) >> 3] >> (BIT(x) & 7)) & 1;
+}
+void GC::mark(DU a, bool pin) {
+    if (!is_obj(a)) return;
+    Obj *o = OBJ(a);
+    if (pin) o->flag |= GC_PIN;
+    if (o->flag & GC_MARK) return;
+    o->flag |= GC_MARK;
+    if (o->atype != T_OBJ && o->atype != T_REF) return;   /// no references inside
+    if (msp < GC_MARK_SZ) ms[msp++] = (IU)a;
+    else overflow = true;
+}
+void GC::scan(IU ox) {
+    refs(ox, [this](DU *r) { mark(*r, false); });
+}
+void GC::fwd(DU *r) {
+    if (is_obj(*r) && (OBJ(*r)->flag & GC_MARK)) *r = OBJ(*r)->lfa;
+}
+///
+/// reference fields of an object, the class chain gives the typed layout
+///
+template<typename F>
+void GC::refs(IU ox, F f) {
+    Obj *o = OBJ(ox);
+    if (o->atype == T_REF) {
+        for (IU i = 0; i < o->n; i++) f((DU*)o->data + i);
+        return;
+    }
+    if (o->atype != T_OBJ) return;
+    for (IU cx = o->n; cx != DATA_NA; cx = *(IU*)WORD(cx)->pfa(PFA_CLS_SUPR)) {
+        IU fx = *(IU*)WORD(cx)->pfa(PFA_CLS_FLD);
+        for (; fx != DATA_NA; fx = WORD(fx)->lfa) {
+            Word *w = WORD(fx);
+            if (FLD_STATIC(w) || !FLD_REF(*w->pfa(PFA_FLD_TYPE))) continue;
+            f((DU*)(o->data + *(IU*)w->pfa(PFA_FLD_OFF)));
+        }
+    }
+}
+template<typename F>
+void GC::statics(F f) {
+    for (IU cx = gPool.cls_root; cx != DATA_NA; cx = WORD(cx)->lfa) {
+        U8 *cv = WORD(cx)->pfa(PFA_CLS_CV);
+        IU fx  = *(IU*)WORD(cx)->pfa(PFA_CLS_FLD);
+        for (; fx != DATA_NA; fx = WORD(fx)->lfa) {
+            Word *w = WORD(fx);
+            if (!FLD_STATIC(w) || !FLD_REF(*w->pfa(PFA_FLD_TYPE))) continue;
+            f((DU*)(cv + *(IU*)w->pfa(PFA_FLD_OFF)));
+        }
+    }
+}
+///
+/// JVM instruction lengths, quick ops included, 0: tableswitch,
+/// lookupswitch and wide, see var_len
+///
+static const U8 op_len[] = {
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,  2,3,2,3,3,2,2,2,2,2,1,1,1,1,1,1,   /// 00
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,  1,1,1,1,1,1,2,2,2,2,2,1,1,1,1,1,   /// 20
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,  1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,   /// 40
+    1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,  1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,   /// 60
+    1,1,1,1,3,1,1,1,1,1,1,1,1,1,1,1,  1,1,1,1,1,1,1,1,1,3,3,3,3,3,3,3,   /// 80
+    3,3,3,3,3,3,3,3,3,2,0,0,1,1,1,1,  1,1,3,3,3,3,3,3,3,5,5,3,2,3,1,1,   /// a0
+    3,3,1,1,0,4,3,3,5,5,1,3,5,3,3,3,  3,3,3,3,3,3,3                      /// c0
+};
+static IU var_len(ClassFile *J, IU pc, IU c0) {
+    U8 op = J->getU8(pc);
+    if (op == 0xc4) return J->getU8(pc + 1) == 0x84 ? 6 : 4;      /// wide iinc, wide load/store
+    IU p = pc + 1 + ((c0 - pc - 1) & 3);                           /// operands 4-byte aligned to code
+    if (op == 0xaa) return p + 12 + 4 * (J->getU32(p + 8) - J->getU32(p + 4) + 1) - pc;
+    return p + 8 + 8 * J->getU32(p + 4) - pc;                      /// lookupswitch
+}
+///
+/// kinds of the locals of a frame by every store in its method, a slot
+/// stored by astore and by a primitive store (reused across scopes) or
+/// never stored (e.g. a parameter) stays untyped, as do all slots of a
+/// method with jsr (return address astore'd) or an unknown opcode
+///
+void GC::slots(Frame &f, int top) {
+    ClassFile *J = f.J;
+    IU  c0 = f.j, c1 = c0 + J->getU32(c0 - 4);
+    int nl = J->getU16(c0 - 6);
+    if (f.sp + nl - 1 > top) return;     /// stale, not an active frame
+    U8  *k = kind + f.sp;
+    memset(k, 0, nl);
+    for (IU pc = c0, n; pc < c1; pc += n) {
+        U8  op = J->getU8(pc);
+        if (op >= sizeof(op_len) || op == 0xa8 || op == 0xc9) { memset(k, 0, nl); return; }
+        n = op_len[op] ? op_len[op] : var_len(J, pc, c0);
+        int s = -1, t = 0;               /// slot, type 0..4: i, l, f, d, a
+        if (op >= 0x36 && op <= 0x3a)      { s = J->getU8(pc + 1); t = op - 0x36; }
+        else if (op >= 0x3b && op <= 0x4e) { s = (op - 0x3b) & 3;  t = (op - 0x3b) >> 2; }
+        else if (op == 0x84)               { s = J->getU8(pc + 1); }
+        else if (op == 0xc4) {
+            U8 w = J->getU8(pc + 1);
+            if (w == 0x84)                 { s = J->getU16(pc + 2); }
+            else if (w >= 0x36 && w <= 0x3a) { s = J->getU16(pc + 2); t = w - 0x36; }
+        }
+        if (s < 0 || s >= nl) continue;
+        k[s] |= t == 4 ? K_REF : K_PRIM;
+        if ((t == 1 || t == 3) && s + 1 < nl) k[s + 1] |= K_PRIM;   /// long, double
+    }
+}
+///
+/// data stack cells of a thread (TOS last), Java frames bottom up, i.e. a
+/// callee types the argument cells it took from its caller
+///
+template<typename F>
+void GC::cells(Thread &t, F f) {
+    int top = t.ss.idx;
+    memset(kind, 0, top + 1);
+    for (int i = 0; i < t.fr.idx; i++) slots(t.fr.v[i], top);
+    for (int p = 0; p <= top; p++) f(p < top ? &t.ss.v[p] : &t.TOS, kind[p]);
+}
+void GC::retire() {
+    for (int i = 0; i < nthr; i++) gPool.tlab_retire(thr[i]->tlab);
+}
+///
+/// object start bitmap, then mark from roots, untyped stack cells pin
+///
+void GC::trace() {
+    Pool &p  = gPool;
+    IU   end = (IU)p.heap.idx;
+    memset(start, 0, HEAP_SZ / sizeof(DU) / 8);
+    for (IU a = OBJ0; a < end; a += OBJ_SPAN(OBJ(a))) {
+        Obj *o = OBJ(a);
+        o->flag &= ~(GC_MARK | GC_PIN);
+        if (o->atype != T_FREE) start[BIT(a) >> 3] |= 1 << (BIT(a) & 7);
+    }
+
+    msp = 0; overflow = false;
+    for (int i = 0; i < nthr; i++) {
+        Thread &t = *thr[i];
+        cells(t, [this](DU *c, U8 k) { if (k != K_PRIM) mark(*c, k != K_REF); });
+        for (int k = 0; k < t.rs.idx; k++) mark(t.rs.v[k], true);
+    }
+    gChan.roots([this](DU v) { mark(v, true); });
+    statics([this](DU *r) { mark(*r, false); });
+    for (;;) {
+        while (msp) scan(ms[--msp]);
+        if (!overflow) break;
+        overflow = false;                /// rescan marked objects
+        for (IU a = OBJ0; a < end; a += OBJ_SPAN(OBJ(a))) {
+            if (!(OBJ(a)->flag & GC_MARK)) continue;
+            scan(a);
+            while (msp) scan(ms[--msp]);
+        }
+    }
+    U32 live = 0;                        /// channels of reachable Channel objects
+    for (IU a = OBJ0; a < end; a += OBJ_SPAN(OBJ(a))) {
+        Obj *o = OBJ(a);
+        if (!(o->flag & GC_MARK) || o->atype != T_OBJ || o->n != gChan.cx) continue;
+        if ((U32)CH_ID(a) < CHAN_MAX) live |= 1u << CH_ID(a);
+    }
+    gChan.keep(live);
+}
+void GC::done(U32 t0, U32 used) {
+    live     = gPool.heap.idx - OBJ0 - gPool.fl_sz;
+    freed    = used - live;
+    freed_t += freed;
+    t_last   = Profiler::clock() - t0;
+    t_sum   += t_last;
+    if (t_last > t_max) t_max = t_last;
+    n++;
+}
+///
+/// mark-sweep, dead objects go to the free list of their size class,
+/// free blocks above the last live object are given back to the top of heap
+///
+void GC::sweep() {
+    U32  t0   = Profiler::clock();
+    Pool &p   = gPool;
+    retire();
+    IU   end  = (IU)p.heap.idx;
+    U32  used = end - OBJ0 - p.fl_sz;
+    trace();
+
+    IU top = OBJ0;
+    for (IU a = OBJ0; a < end; a += OBJ_SPAN(OBJ(a))) {
+        Obj *o = OBJ(a);
+        if (o->atype != T_FREE && (o->flag & GC_MARK)) top = a + OBJ_SPAN(o);
+    }
+    IU prev = DATA_NA;
+    objs = pinned = 0;
+    p.fl_reset();
+    for (IU a = OBJ0, nx; a < top; a = nx) {
+        Obj *o = OBJ(a);
+        nx = a + OBJ_SPAN(o);
+        if (o->atype == T_FREE || !(o->flag & GC_MARK)) { p.obj_free(a); continue; }
+        if (o->flag & GC_PIN) pinned++;
+        o->flag &= ~(GC_MARK | GC_PIN);
+        o->lfa  = prev;
+        prev    = a;
+        objs++;
+    }
+    p.heap.idx = top;
+    p.obj_root = prev;
+    done(t0, used);
+}
+///
+/// mark-compact (sliding), objects keep their allocation order
+///   1. trace
+///   2. forwarding address into Obj.lfa
+///   3. forward typed references (fields, reference arrays, typed locals)
+///   4. slide objects down, relink obj_root list
+///
+void GC::collect() {
+    U32  t0   = Profiler::clock();
+    Pool &p   = gPool;
+    retire();
+    IU   end  = (IU)p.heap.idx;
+    U32  used = end - OBJ0 - p.fl_sz;
+    trace();
+
+    IU free = OBJ0;
+    objs = pinned = 0;
+    for (IU a = OBJ0; a < end; a += OBJ_SPAN(OBJ(a))) {
+        Obj *o = OBJ(a);
+        if (o->atype == T_FREE || !(o->flag & GC_MARK)) continue;
+        if (o->flag & GC_PIN) { free = a; pinned++; }
+        o->lfa = free;
+        free  += OBJ_SPAN(o);
+        objs++;
+    }
+
+    statics([this](DU *r) { fwd(r); });
+    for (int i = 0; i < nthr; i++) cells(*thr[i], [this](DU *c, U8 k) { if (k == K_REF) fwd(c); });
+    for (IU a = OBJ0; a < end; a += OBJ_SPAN(OBJ(a))) {
+        if (OBJ(a)->atype != T_FREE && (OBJ(a)->flag & GC_MARK)) refs(a, [this](DU *r) { fwd(r); });
+    }
+
+    IU prev = DATA_NA;
+    free = OBJ0;
+    p.fl_reset();
+    for (IU a = OBJ0, nx; a < end; a = nx) {
+        Obj *o = OBJ(a);
+        nx = a + OBJ_SPAN(o);
+        if (o->atype == T_FREE || !(o->flag & GC_MARK)) continue;
+        IU to = o->lfa;
+        if (to > free) {                 /// dead space in front of a pinned object
+            OBJ(free)->sz = to - free - sizeof(Obj);
+            p.obj_free(free);
+        }
+        if (to != a) memmove(&p.heap[to], &p.heap[a], nx - a);
+        o = OBJ(to);
+        o->flag &= ~(GC_MARK | GC_PIN);
+        o->lfa  = prev;
+        prev    = to;
+        free    = to + (nx - a);
+    }
+    p.heap.idx  = free;
+    p.obj_root  = prev;
+    nc++;
+    done(t0, used);
+}
+///
+/// fragmentation: share of free space (free blocks and top of heap)
+/// that is not in the largest piece
+///
+void GC::dump() {
+#if ARDUINO
+    const char *unit = "us";
+#else
+    const char *unit = "ns";
+#endif // ARDUINO
+    Pool &p   = gPool;
+    U32  used = p.heap.idx - OBJ0 - p.fl_sz;
+    U32  top  = HEAP_SZ - ALIGN_DU(p.heap.idx), big = top;
+    LOG("\ngc: "); LOU(n); LOG(" collections ("); LOU(nc); LOG(" compacting), heap ");
+    LOU(used); LOG("/"); LOU(HEAP_SZ - OBJ0); LOG(" bytes (");
+    LOU(used * 100 / (HEAP_SZ - OBJ0)); LOG("%), high water "); LOU(p.heap.max);
+    LOG("\n  free: "); LOU(p.fl_sz); LOG(" in blocks, "); LOU(top); LOG(" on top");
+    for (int c = 0; c <= FL_CLS; c++) {
+        U32 k = 0;
+        for (IU ox = p.fl[c]; ox != DATA_NA; ox = OBJ(ox)->lfa) {
+            if (OBJ_SPAN(OBJ(ox)) > big) big = OBJ_SPAN(OBJ(ox));
+            k++;
+        }
+        if (!k) continue;
+        LOG(c < FL_CLS ? " [" : " [>"); LOU((c < FL_CLS ? c + OBJ_HDR : FL_CLS + OBJ_HDR - 1) * sizeof(DU));
+        LOG("]x"); LOU(k);
+    }
+    U32 fsz = p.fl_sz + top;
+    LOG("\n  largest="); LOU(big); LOG(" fragmentation="); LOU(fsz ? 100 - big * 100 / fsz : 0); LOG("%");
+    if (n) {
+        LOG("\n  last: live="); LOU(live); LOG(" objs="); LOU(objs);
+        LOG(" pinned="); LOU(pinned); LOG(" freed="); LOU(freed);
+        LOG("\n  pause ("); LOG(unit); LOG("): last="); LOU(t_last);
+        LOG(" max="); LOU(t_max); LOG(" avg="); LOU(t_sum / n);
+        LOG("\n  freed total="); LOU(freed_t);
+    }
+    LOG("\n  tlab refills="); LOU(p.tlab_n);
+    LOG("\n");
+}
@@ -0,0 +1,87 @@
+///
+/// @brief nanoJVM garbage collector for gPool.heap
+/// Note:
+///   * roots are the data and return stacks of attached threads (locals
+///     live there too), cells in flight on channels and static reference
+///     fields of every class
+///   * a local that its method only ever stores with astore is a typed
+///     reference (forwarded), one only stored by primitive stores is no
+///     root, the method bytecode of each Java frame tells, see slots()
+///   * other stack cells (operands, mixed or unstored locals, return stack)
+///     and channel cells carry no type, a cell that equals an object start
+///     is taken as a reference and pins the object, i.e. it is never rewritten
+///   * sweep() returns dead objects to the size class free lists of Pool
+///     and trims the top of heap, nothing moves
+///   * collect() compacts: typed references (static/instance fields,
+///     reference arrays) are forwarded, unpinned objects slide down, the
+///     space in front of a pinned object becomes a free block
+///   * Pool::obj_hdr sweeps when out of heap and compacts when the
+///     request still does not fit, Forth word gc compacts
+///   * references kept in Forth variables (pmem) are not roots
+///   * TLABs of attached threads are retired before each collection
+///   * channels whose Channel object is unreachable are closed
+///
+#ifndef NANOJVM_GC_H
+#define NANOJVM_GC_H
+#include "core.h"
+
+#define GC_MARK     0x01          /** Obj.flag: reachable               */
+#define GC_PIN      0x02          /** Obj.flag: held by a stack cell    */
+#define K_REF       0x01          /** local only stored by astore       */
+#define K_PRIM      0x02          /** local only stored by i/l/f/dstore */
+
+struct Frame;
+
+struct GC {
+    Thread *thr[GC_ROOT_SZ];      /// threads whose stacks are roots
+    int    nthr    = 0;
+    ///
+    /// statistics
+    ///
+    U32    n       = 0;           /// collections run (sweep or compact)
+    U32    nc      = 0;           /// of which compacting
+    U32    objs    = 0;           /// live objects after last collection
+    U32    pinned  = 0;           /// pinned objects in last collection
+    U32    live    = 0;           /// heap bytes in use after last collection
+    U32    freed   = 0;           /// bytes reclaimed by last collection
+    U64    freed_t = 0;           /// bytes reclaimed in total
+    U32    t_last  = 0;           /// pause time of last collection
+    U32    t_max   = 0;           /// longest pause
+    U64    t_sum   = 0;           /// accumulated pause time
+
+    GC() {
+        start = new U8[HEAP_SZ / sizeof(DU) / 8];
+        ms    = new IU[GC_MARK_SZ];
+        kind  = new U8[SS_SZ + 1];
+    }
+    ~GC() { delete[] start; delete[] ms; delete[] kind; }
+
+    void attach(Thread &t);       /// add thread stack to root set
+    void detach(Thread &t);
+    void sweep();                 /// mark-sweep into free lists
+    void collect();               /// mark-compact
+    void dump();                  /// occupancy, fragmentation and pause time
+
+private:
+    U8   *start;                  /// object start bitmap, one bit per DU
+    IU   *ms;                     /// mark stack
+    U8   *kind;                   /// K_REF, K_PRIM per stack cell of a thread
+    int  msp;
+    bool overflow;                /// mark stack overflowed, rescan heap
+
+    void retire();                /// TLABs back to the shared heap
+    void trace();                 /// mark everything reachable from roots
+    void done(U32 t0, U32 used);  /// update statistics
+    bool is_obj(DU a);
+    void mark(DU a, bool pin);
+    void scan(IU ox);             /// mark objects referenced by ox
+    void fwd(DU *p);              /// forward a typed reference
+    template<typename F>
+    void refs(IU ox, F f);        /// call f(DU*) on each reference field of ox
+    template<typename F>
+    void statics(F f);            /// call f(DU*) on each static reference field
+    void slots(Frame &f, int top);/// kind of each local of a frame
+    template<typename F>
+    void cells(Thread &t, F f);   /// call f(DU*, kind) on each stack cell of t
+};
+#endif // NANOJVM_GC_H
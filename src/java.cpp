@@ -1,16 +1,21 @@
 #include <sstream>      // stringstream
 #include <iostream>     // cin, cout
 #include <iomanip>      // setbase
+#include <math.h>       // signbit, fabs
 #include "ucode.h"		// microcode manager (include mmu.h, thread.h, loader.h)
 #include "java.h"		// java front-end interface
+#include "trace.h"      // execution tracer
+#include "profile.h"    // execution profiler
+#include "gc.h"         // garbage collector
+#include "task.h"       // native threads
+#include "monitor.h"    // object monitors
 
 using namespace std;    // default to C++ standard template library
 ///
-/// JVM streaming IO
+/// JVM streaming IO, per VM
 ///
-ostringstream   jout;                         /// JVM output stream
-void null_con(int n, const char* msg) {};     /// null console
-void (*jout_cb)(int, const char*) = null_con; /// JVM output callback function
+#define jout    (gVM->jout)                   /** JVM output stream          */
+#define jout_cb (gVM->jout_cb)                /** JVM output callback function */
 
 #define ENDL    endl; jout_cb(jout.str().length(), jout.str().c_str()); jout.str("")
 ///
@@ -19,12 +24,12 @@ void (*jout_cb)(int, const char*) = null_con; /// JVM output callback function
 extern   Ucode  uCode;                  /// Java microcode ROM
 extern   Ucode  uForth;                 /// Forth microcode ROM
 extern   Ucode  uESP32;                 /// ESP32 supporting functions
-extern   Pool   gPool;                  /// memory pool manager
+extern   Ucode  uThread;                /// java/lang/Thread natives
+extern   Ucode  uChannel;               /// ej32/Channel natives
 ///
 /// Java Native IO functions
-/// Note: support only string and integer (like Arduino)
+/// Note: support only string, integer, long, float and double (like Arduino)
 ///
-Thread gT0;                             /// default thread, TODO: multi-thread
 
 void _print_s(Thread &t) {
 	IU j = t.pop(), ox = t.pop();  /// java constant pool object
@@ -32,26 +37,79 @@ void _print_s(Thread &t) {
 	jout << " " << t.J->getStr(j, buf, true);
 }
 void _print_i(Thread &t) {
-	IU j = t.pop(), ox = t.pop();  /// java constant pool object
-	jout << " " << setbase(t.base) << j;
+	DU v = t.pop(); t.pop();       /// value, PrintStream object
+	jout << " " << setbase(t.base) << v;
+}
+void _print_l(Thread &t) {
+	S64 v = t.pop2(); t.pop();     /// value (two cells), PrintStream object
+	jout << " " << setbase(t.base) << v;
+}
+///
+/// Java Float/Double.toString layout: shortest digits that read back to
+/// the same value, fixed for 1e-3 <= |v| < 1e7 with at least one decimal,
+/// else d.dddE<n>
+///
+static string _jfloat(F64 v, bool dbl) {
+    if (v != v) return "NaN";
+    if (v - v != 0) return v > 0 ? "Infinity" : "-Infinity";
+    if (v == 0) return signbit(v) ? "-0.0" : "0.0";
+    char buf[40];
+    int  p = 0;
+    for (; p < 17; p++) {                   /// p digits after the first
+        snprintf(buf, sizeof(buf), "%.*e", p, v);
+        F64 r = strtod(buf, NULL);
+        if (dbl ? r == v : (F32)r == (F32)v) break;
+    }
+    int  e = atoi(strchr(buf, 'e') + 1);
+    F64  a = fabs(v);
+    if (a >= 1e-3 && a < 1e7) {
+        snprintf(buf, sizeof(buf), "%.*f", p > e ? p - e : 1, v);
+        return buf;
+    }
+    *strchr(buf, 'e') = 0;
+    if (!strchr(buf, '.')) strcat(buf, ".0");
+    return string(buf) + "E" + to_string(e);
+}
+void _print_f(Thread &t) {
+	F32 v = bitsf(t.pop()); t.pop(); /// value, PrintStream object
+	jout << " " << _jfloat(v, false);
+}
+void _print_d(Thread &t) {
+	F64 v = bitsd(t.pop2()); t.pop(); /// value (two cells), PrintStream object
+	jout << " " << _jfloat(v, true);
 }
 void _println_s(Thread &t) { _print_s(t); jout << ENDL; }
 void _println_i(Thread &t) { _print_i(t); jout << ENDL; }
+void _println_l(Thread &t) { _print_l(t); jout << ENDL; }
+void _println_f(Thread &t) { _print_f(t); jout << ENDL; }
+void _println_d(Thread &t) { _print_d(t); jout << ENDL; }
 ///
 /// JVM Core
 ///
-int  java_setup(void (*callback)(int, const char*)) {
-	const static Method uObj[] = {{ "<init>", [](Thread &t){ t.pop(); }, ACL_PUBLIC, "()V" }};
+int  java_setup(void (*callback)(int, const char*), int quantum) {
+	const static Method uObj[] = {
+	    { "<init>",    [](Thread &t){ t.pop(); }, ACL_PUBLIC, "()V" },
+	    { "wait",      [](Thread &t){ gMon.wait(t, &OBJ(t.TOS)->lock); t.pop(); },          ACL_PUBLIC, "()V" },
+	    { "notify",    [](Thread &t){ gMon.notify(t, &OBJ(t.TOS)->lock, false); t.pop(); }, ACL_PUBLIC, "()V" },
+	    { "notifyAll", [](Thread &t){ gMon.notify(t, &OBJ(t.TOS)->lock, true); t.pop(); },  ACL_PUBLIC, "()V" }
+	};
     const static Method uStr[] = {{ "<init>", [](Thread &t){ t.pop(); }, ACL_PUBLIC, "()V" }};
 	const static Method uSys[] = {{ "<init>", [](Thread &t){ t.pop(); }, ACL_PUBLIC, "()V" }};
     const static Method uPrs[] = {
     	{ "print",   _print_s,   ACL_PUBLIC, "(Ljava/lang/String;)V" },
     	{ "print",   _print_i,   ACL_PUBLIC, "(I)V" },
+    	{ "print",   _print_l,   ACL_PUBLIC, "(J)V" },
+    	{ "print",   _print_f,   ACL_PUBLIC, "(F)V" },
+    	{ "print",   _print_d,   ACL_PUBLIC, "(D)V" },
     	{ "println", _println_s, ACL_PUBLIC, "(Ljava/lang/String;)V" },
-    	{ "println", _println_i, ACL_PUBLIC, "(I)V" }
+    	{ "println", _println_i, ACL_PUBLIC, "(I)V" },
+    	{ "println", _println_l, ACL_PUBLIC, "(J)V" },
+    	{ "println", _println_f, ACL_PUBLIC, "(F)V" },
+    	{ "println", _println_d, ACL_PUBLIC, "(D)V" }
     };
     setvbuf(stdout, NULL, _IONBF, 0);
     if (callback) jout_cb = callback;
+    if (quantum)  gVM->quantum = quantum;     /// opcodes per time slice
     ///
     /// populate Java classes
     ///
@@ -60,12 +118,20 @@ int  java_setup(void (*callback)(int, const char*)) {
     gPool.register_class("java/lang/String",   uStr,      VTSZ(uStr), "java/lang/Object", sizeof(DU)*3, 0);
     gPool.register_class("java/lang/System",   uSys,      VTSZ(uSys), "java/lang/Object", sizeof(DU)*3, 0);
     gPool.register_class("java/io/PrintStream",uPrs,      VTSZ(uPrs), "java/lang/Object");
+    IU f_thr = DATA_NA;                       /// Thread fields, target is a gc reference
+    gPool.add_field(f_thr, "target", 0, TYPE_OBJ, 0);
+    gPool.add_field(f_thr, "tid",    0, TYPE_INT, sizeof(DU));
+    gPool.register_class("java/lang/Thread",   uThread.vt,uThread.vtsz,"java/lang/Object", 0, sizeof(DU)*2, f_thr);
     gPool.jvm_root = gPool.cls_root;
     ///
     /// Add Forth classes
     ///
     gPool.register_class("ej32/Forth", uForth.vt, uForth.vtsz, "java/lang/Object");
     gPool.register_class("ej32/ESP32", uESP32.vt, uESP32.vtsz, "ej32/Forth");
+    IU f_ch = DATA_NA;                        /// Channel fields, index into gChan
+    gPool.add_field(f_ch, "id", 0, TYPE_INT, 0);
+    gPool.register_class("ej32/Channel", uChannel.vt, uChannel.vtsz, "java/lang/Object", 0, sizeof(DU), f_ch);
+    gChan.cx = gPool.get_class("ej32/Channel");
     gPool.build_op_lookup();
 
     return 0;
@@ -73,6 +139,11 @@ int  java_setup(void (*callback)(int, const char*)) {
 int java_load(const char *fname) {
     return Loader::load(fname);
 }
+void java_trace(int level) { gTrace.level = (U8)level; }
+void java_trace_dump()     { gTrace.dump(); gTrace.clear(); }
+void java_profile(int on)  { if (on) gProf.clear(); gProf.on = on != 0; }
+void java_profile_dump(int top) { gProf.dump(top); }
+void java_gc_dump()        { gGC.dump(); }
 
 #if ARDUINO
 extern void forth_outer(Thread &t, const char *cmd);
@@ -81,9 +152,11 @@ void mem_stat(Thread &t) {
     LOG(" heap[maxblk=");   LOX(heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
     LOG(", avail=");        LOX(heap_caps_get_free_size(MALLOC_CAP_8BIT));
     LOG(", ss_max=");       LOX(t.ss.max);
-    LOG(", rs_max=");       LOX(gPool.rs.max);
+    LOG(", rs_max=");       LOX(t.rs.max);
     LOG(", pmem=");         LOX(gPool.pmem.idx);
     LOG(", objs=");         LOX(gPool.heap.idx);
+    LOG(", cpool=");        LOX(Loader::cpool_size());
+    LOG(", dict_hx=");      LOX(gPool.hx.idx);
     LOG("], lowest[heap="); LOX(heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
     LOG(", stack=");        LOX(uxTaskGetStackHighWaterMark(NULL));
     LOG("]\n");
@@ -105,15 +178,18 @@ void java_run() {
     if (Serial.available()) {
         console_cmd = Serial.readString();
         LOG(console_cmd);
+        vm_acquire();            /// Java threads may be running
         forth_outer(gT0, console_cmd.c_str());
+        vm_release();
         mem_stat(gT0);
         delay(2);
     }
+    else task_yield();           /// console idle, Java threads run
 }
 #else
 void java_run() {
     ///
-    /// instantiate main thread (TODO: single thread for now)
+    /// instantiate main thread
     ///
 	int jcf = Loader::active();
 	gT0.init(jcf);
@@ -122,6 +198,7 @@ void java_run() {
 	///
     IU mx = gPool.get_method("main");
     gT0.dispatch(mx);
+    task_join_all();                     /// main returns when all threads did
 }
 #endif // ARDUINO
 
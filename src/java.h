@@ -3,9 +3,14 @@
 ///
 /// Java front-end interface
 ///
-int  java_setup(void (*callback)(int, const char*)=NULL);
+int  java_setup(void (*callback)(int, const char*)=NULL, int quantum=0);
 int  java_load(const char *fname);
 void java_run();         // virtual function
+void java_trace(int level);  // 0:off, 1:calls, 2:instructions, 3:stack
+void java_trace_dump();      // decode trace ring buffer
+void java_profile(int on);   // 0:off, 1:clear counters and start
+void java_profile_dump(int top=20);  // sorted opcode and word tables
+void java_gc_dump();         // heap occupancy and gc pause times
 
 #endif // NANOJVM_JAVA_H
 
@@ -1,5 +1,7 @@
-#include "loader.h"
-#include "mmu.h"
+#include "vm.h"     // class files and gPool of the current VM
+#if !ARDUINO && __linux__
+#include <sys/mman.h>   // mmap
+#endif
 ///
 /// Loader - private methods
 ///
@@ -14,7 +16,13 @@ U8 ClassFile::type_size(char type){
 IU ClassFile::attr_size(IU addr){
     return (IU)6 + getU32(addr + 2);
 }
-U8 ClassFile::field_size(IU &addr) {
+///
+/// field word with its storage offset (bytes)
+///   static:   DU cell(s) in class storage, created on the first pass
+///   instance: packed at natural width (aligned up to DU), one pass per width w
+///
+void ClassFile::create_field(IU &f_root, IU &addr, U8 w, IU &cv, IU &iv) {
+    U16 flag = getU16(addr);                     // access flags
     U16 ifld = getU16(addr + 2);                 // field name index
     U16 itype= getU16(addr + 4);                 // read type destriptor index
     U16 xsz  = getU16(addr + 6);                 // get number of filed attributes
@@ -22,45 +30,59 @@ U8 ClassFile::field_size(IU &addr) {
     addr += 8;                                   // pointer to field attributes
     while (xsz--) addr += attr_size(addr);      //
 
-    return type_size(type);
+    bool st = flag & ACC_STATIC;
+    U8   sz = type_size(type);
+    if (st ? w != 8 : sz != w) return;          // not in this pass
+    if (st) sz = sz > sizeof(DU) ? sizeof(DU)*2 : sizeof(DU);
+
+    IU   &off = st ? cv : iv;
+    U8   al   = sz < sizeof(DU) ? sz : sizeof(DU);
+    off = (off + al - 1) & ~(al - 1);           // align to field size
+
+    char name[128];
+    getStr(ifld, name);
+    gPool.add_field(f_root, name, st ? STATIC_FLAG : 0, type, off);
+    off += sz;
 }
-void ClassFile::create_method(char *cls, IU &m_root, IU &addr) {
+void ClassFile::create_method(char *cls, IU jdx, IU &m_root, IU &addr) {
+    U16 acc     = getU16(addr);
     U16 i_name  = getU16(addr + 2);
     U16 i_parm  = getU16(addr + 4);
     U16 n_attr  = getU16(addr + 6);
     addr += 8;
 
     IU  mjdx = addr + 14;
-    U32 len  = getU32(mjdx - 4);
 
     char name[128], parm[32];
     getStr(i_name, name);
     getStr(i_parm, parm);
 
 #if ENABLE_DEBUG
+    U32 len  = getU32(mjdx - 4);        // code length
     LOG("\n  ["); LOX2(i_name); LOG("]");
     LOG(cls);  LOG("::");
     LOG(name); LOG(parm); LOG(" ("); LOX(len); LOG(" bytes)");
 #endif // ENABLE_DEBUG
 
     IU pidx = gPool.get_parm_idx(parm);
-    gPool.add_method(m_root, name, mjdx, pidx);
+    U8  flag = (acc & ACC_STATIC ? STATIC_FLAG : 0) | (acc & ACC_SYNC ? SYNC_FLAG : 0);
+    gPool.add_method(m_root, name, mjdx, pidx, jdx, flag);
 
     while (n_attr--) addr += attr_size(addr);
 }
 ///
 /// Loader - public methods
 ///
-U8 ClassFile::getU8(IU addr) {
+U8 ClassFile::sU8(IU addr) {
     FSEEK(f, addr);
     return FGETC(f);
 }
-U16 ClassFile::getU16(IU addr) {
-    U16 v = (U16)getU8(addr) << 8;
+U16 ClassFile::sU16(IU addr) {
+    U16 v = (U16)sU8(addr) << 8;
     return v | FGETC(f);
 }
-U32 ClassFile::getU32(IU addr) {
-    U32 v = (U32)getU8(addr);
+U32 ClassFile::sU32(IU addr) {
+    U32 v = (U32)sU8(addr);
     for(U8 i = 0; i < 3; i++) v = (v << 8) | FGETC(f);
     return v;
 }
@@ -71,23 +93,25 @@ char *ClassFile::getStr(IU idx, char *buf, bool ref) {
     	n = offset(n - 1);          /// [17]:00b6:1=>ej32/Forth
     }
     U16 i, len = getU16(n + 1);
-    FSEEK(f, n + 3);		        /// move cursor to string
-    for (i=0; i<len; i++)   {
-        buf[i] = FGETC(f);
+    if (img) memcpy(buf, &img[n + 3], i = len);
+    else {
+        FSEEK(f, n + 3);		    /// move cursor to string
+        for (i=0; i<len; i++) buf[i] = FGETC(f);
     }
     buf[i] = '\0';
     return buf;
 }
 ///
-/// calculate offset of an index in constant pool
+/// build constant pool offset table in one pass
+/// Note: LONG/DOUBLE take two slots, the unusable 2nd slot points to next entry
 ///
-U16 ClassFile::offset(U16 jdx, bool debug) {
+IU ClassFile::build_offset(bool debug) {
+    U16 n = getU16(8) - 1;          /// number of constant pool entries
+    cpool = new U16[n + 1];         /// extra slot for end of pool
+    cpsz  = (n + 1) * sizeof(U16);
     IU addr = 10;
-    ///
-    /// loop over the constant pool to get the offset
-    /// TODO: this is a very inefficient way of keeping indices
-    ///
-    for (int i=0; i<jdx; i++) {
+    for (int i=0; i<n; i++) {
+        cpool[i] = addr;
         U8 t = getU8(addr);
         if (debug) {
             LOG("\n["); LOX2(i+1); LOG("]"); LOX4(addr); LOG(":"); LOX2(t);
@@ -111,7 +135,9 @@ U16 ClassFile::offset(U16 jdx, bool debug) {
             addr += 2; break;
         case CONST_LONG:
         case CONST_DOUBLE:
-            addr += 8; i++;  break;
+            addr += 8;
+            if (++i < n) cpool[i] = addr;
+            break;
         case CONST_FIELD:
         case CONST_METHOD:
         case CONST_NAME_TYPE:
@@ -123,7 +149,7 @@ U16 ClassFile::offset(U16 jdx, bool debug) {
         default: addr += 4; break;
         }
     }
-    return addr;
+    return cpool[n] = addr;         /// end of constant pool
 }
 /*
  * JVM class file format references
@@ -170,30 +196,57 @@ attribute_info {
     u1 info[attribute_length];
 }
 */
+///
+/// load whole class file into a contiguous memory image
+/// Note: mmap on Linux (private, copy-on-write for quickening), heap buffer
+///       otherwise, keep streaming from file (i.e. SPIFFS) if memory cannot be allocated
+///
+void ClassFile::open_image() {
+#if CLSFILE_IMAGE
+#if ARDUINO
+    isz = FSIZE(f);
+    img = (U8*)malloc(isz);
+    if (!img) return;                         /// not enough RAM, stream instead
+    FSEEK(f, 0);
+    if (f.read(img, isz) != isz) { free(img); img = 0; }
+#else
+    isz = FSIZE(f);
+#if __linux__
+    void *p = mmap(NULL, isz, PROT_READ|PROT_WRITE, MAP_PRIVATE, fileno(f), 0);
+    if (p != MAP_FAILED) { img = (U8*)p; mapped = true; return; }
+#endif // __linux__
+    img = (U8*)malloc(isz);
+    if (!img) return;
+    FSEEK(f, 0);
+    if (fread(img, 1, isz, f) != isz) { free(img); img = 0; }
+#endif // ARDUINO
+#endif // CLSFILE_IMAGE
+}
 ClassFile::ClassFile(const char *fname) {
 	this->fname = fname;
 #if ARDUINO
     if (!SPIFFS.begin()) { LOG("failed to open SPIFFS"); }
     f = SPIFFS.open(fname, "r");
-    if (!f.available()) { LOG("failed to open file: "); LOG(fname); }
+    if (!f.available()) { LOG("failed to open file: "); LOG(fname); return; }
 #else
     f = fopen(fname, "rb");
-    if (!f) { LOG("failed to open file: "); LOG(fname); }
+    if (!f) { LOG("failed to open file: "); LOG(fname); return; }
 #endif
+    open_image();
 #if ENABLE_DEBUG
     LOG("\nJava class file: "); LOG(fname);
+    LOG(img ? " (image)" : " (stream)");
 #endif // ENABLE_DEBUG
 #if LOADER_DUMP
     ///
     /// dump Java class file content
     ///
     U32 sz = FSIZE(f);
-    FSEEK(f, 0);
 	char buf[17] = { 0 };
-    for (IU i=0; i<=sz; i+=16) {
+    for (U32 i=0; i<=sz; i+=16) {
         LOG("\n"); LOX4(i); LOG(": ");
-        for (int j=0; j<16; j++) {
-            char c = FGETC(f);
+        for (U32 j=0; j<16; j++) {
+            char c = (i+j) < sz ? getU8(i+j) : 0xff;
             buf[j] = ((c>0x7f)||(c<0x20)) ? '_' : c;
             LOX2((int)c); LOG(j%4==3 ? "  " : " ");
         }
@@ -202,11 +255,24 @@ ClassFile::ClassFile(const char *fname) {
     }
 #endif // LOADER_DUMP
 }
-U16 ClassFile::load(IU jdx) {
+ClassFile::~ClassFile() {
+    delete[] cpool;
+#if ARDUINO
+    if (img) free(img);
+    f.close();
+#else
+#if __linux__
+    if (mapped) munmap(img, isz);
+    else
+#endif // __linux__
+    if (img) free(img);
+    if (f) fclose(f);
+#endif // ARDUINO
+}
+IU ClassFile::load(IU jdx) {
     if ((U32)getU32(0) != MAGIC) return ERR_MAGIC;
 
-    U16 n_cnst = getU16(8) - 1;                 // number of constant pool entries
-    IU  addr   = offset(n_cnst, LOADER_DUMP);   // skip constant descriptors
+    IU  addr   = build_offset(LOADER_DUMP);     // index and skip constant descriptors
     U16 acc    = getU16(addr);  addr += 2;      // class access flag
     U16 i_cls  = getU16(addr);  addr += 2;      // this class
     U16 i_supr = getU16(addr);  addr += 2;      // super class
@@ -220,13 +286,13 @@ U16 ClassFile::load(IU jdx) {
     U16 n_fld  = getU16((addr += n_intf*2));    // number of fields
     IU  p_fld  = (addr += 2);
 
-    U16 sz_cv = 0, sz_iv = 0;
-    while (n_fld--) {                           // scan fields
-        U16 flag = getU16(addr);                // get access flags
-        bool is_cls = flag & ACC_STATIC;
-        U8 sz = field_size(addr);               // process one field_info
-        if (is_cls) sz_cv += sz;
-        else        sz_iv += sz;
+    IU  sx     = gPool.get_class(supr);         // instance fields follow super's
+    IU  sz_cv  = 0;
+    IU  sz_iv  = sx==DATA_NA ? 0 : *(IU*)WORD(sx)->pfa(PFA_CLS_IVSZ);
+    IU  f_root = DATA_NA;
+    for (U8 w = 8; w; w >>= 1) {                // pack fields, widest first
+        addr = p_fld;
+        for (U16 i=0; i<n_fld; i++) create_field(f_root, addr, w, sz_cv, sz_iv);
     }
     U16 n_method = getU16(addr);                // number of methods
     IU  p_method = (addr += 2);                 // pointer to methods
@@ -237,25 +303,30 @@ U16 ClassFile::load(IU jdx) {
     LOG("\n  p_intf=");   LOX(p_intf);   LOG(", p_attr=");   LOX(p_fld);
     LOG("\n  sz_cls=");   LOX(sz_cv);    LOG(", sz_inst=");  LOX(sz_iv);
     LOG("\n  n_method="); LOX(n_method); LOG(", p_method="); LOX(p_method);
+    LOG("\n  cpsz=");     LOX(cpsz);
     LOG("\n} loaded.");
 #endif // LOADER_DUMP
     
     IU  m_root = DATA_NA;
     for (int i=0; i<n_method; i++) {
-    	create_method(cls, m_root, addr);
+    	create_method(cls, jdx, m_root, addr);
     }
-    return this->ctx = gPool.add_class(cls, jdx, m_root, supr, sz_cv, sz_iv);
+    return this->ctx = gPool.add_class(cls, jdx, m_root, supr, sz_cv, sz_iv, f_root);
 }
 ///
 /// Loader class implementation
 ///
-ClassFile *clsfile[CLSFILE_MAX];
-int Loader::cnt = 0;
+int Loader::cpool_size() {
+    int sz = 0;
+    for (int i=0; i<gVM->ncls; i++) sz += gVM->clsfile[i]->cpsz;
+    return sz;
+}
 int Loader::load(const char *fname) {
+    VM  &vm = *gVM;
 	ClassFile *cf = new ClassFile(fname);
 	if (cf) {
-		cf->load(cnt);
-		clsfile[cnt++] = cf;
+		cf->load(vm.ncls);
+		vm.clsfile[vm.ncls++] = cf;
 	}
-	return cnt;
+	return vm.ncls;
 }
@@ -32,6 +32,7 @@
 #define TYPE_ARRAY      '['
 #define TYPE_OBJ        'L'
 #define TYPE_OBJ_END    ';'
+#define TYPE_WIDE(t)    ((t)==TYPE_LONG || (t)==TYPE_DOUBLE)  /** two stack/local slots */
 ///
 /// signature and error codes
 ///
@@ -62,34 +63,69 @@ class ClassFile {
     FILE *f;
 #endif
 	const char *fname;
+    U8   *img  = 0;       /// in-memory class file image (0: streaming from file)
+    U32  isz   = 0;       /// image size in bytes
+    bool mapped = false;  /// image is mmap'ed (Linux) instead of allocated
+    U16  *cpool = 0;      /// constant pool offset table, one entry per slot
+
+    void open_image();
+    IU   build_offset(bool debug=false);
+    U8   sU8(IU addr);    /// streaming (file) fetchers, used when no image
+    U16  sU16(IU addr);
+    U32  sU32(IU addr);
+
     U8   type_size(char type);
-    U16  attr_size(U16 addr);
-    U8   field_size(U16 &addr);
+    IU   attr_size(IU addr);
+    void create_field(IU &f_root, IU &addr, U8 w, IU &cv, IU &iv);
 
-    void create_method(char *cls, U16 &m_root, U16 &addr);
+    void create_method(char *cls, IU jdx, IU &m_root, IU &addr);
     
 public:
 	IU   ctx;             /// context (class addr in dictionary)
+    U16  cpsz = 0;        /// size of constant pool offset table (in bytes)
 
     ClassFile(const char *fname);
+    ~ClassFile();
     IU   load(IU jdx);
 
-    U8   getU8(U16 addr);
-    U16  getU16(U16 addr);
-    U32  getU32(U16 addr);
-    U16  offset(U16 idx, bool debug=false);
+    ///
+    /// big-endian fetchers, straight from memory image if available
+    ///
+    U8   getU8(IU addr)  { return img ? img[addr] : sU8(addr); }
+    U16  getU16(IU addr) {
+        if (!img) return sU16(addr);
+        U8 *p = &img[addr];
+        return ((U16)p[0] << 8) | p[1];
+    }
+    U32  getU32(IU addr) {
+        if (!img) return sU32(addr);
+        U8 *p = &img[addr];
+        return ((U32)p[0] << 24) | ((U32)p[1] << 16) | ((U32)p[2] << 8) | p[3];
+    }
+    U16  offset(U16 idx) { return cpool[idx]; }  /// constant pool entry offset
+    U8   *image()        { return img; }         /// memory image, 0 if streaming
+    ///
+    /// rewrite an opcode and its 16-bit operand in place (quickening)
+    /// Note: operand written before opcode, returns false if streaming from file
+    ///
+    bool patch(IU addr, U8 op, U16 v) {
+        if (!img) return false;
+        img[addr + 1] = (U8)(v >> 8);
+        img[addr + 2] = (U8)(v & 0xff);
+        img[addr]     = op;
+        return true;
+    }
 
-    char *getStr(U16 addr, char *buf, bool ref=false);
+    char *getStr(IU addr, char *buf, bool ref=false);
 };
 ///
-/// Class File Manager
+/// Class File Manager, class files of the current VM (inline in vm.h)
 ///
-extern ClassFile *clsfile[CLSFILE_MAX];
 class Loader {
-	static int cnt;
 public:
-	static int active()            { return cnt ? cnt - 1 : 0; }
-	static ClassFile *get(int jcf) { return clsfile[jcf]; }
+	static int active();
+	static ClassFile *get(int jcf);
 	static int load(const char *fname);
+	static int cpool_size();       /// total bytes of constant pool offset tables
 };
 #endif // NANOJVM_LOADER_H
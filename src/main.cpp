@@ -3,25 +3,76 @@
 #include "java.h"   // Java front-end interface
 
 #ifndef ARDUINO
+#include <vector>
+#include "exec.h"   // job executor
+
 void send_to_console(int, const char* msg) { printf("%s", msg); }
+///
+/// each file is a job (a.class,b.class: loaded together), run on n workers
+///
+int run_jobs(int n, std::vector<const char*> &files) {
+    Executor ex(n);
+    std::vector<std::future<JobResult>> f;
+    for (auto c : files) f.push_back(ex.submit(c));
+    int err = 0;
+    for (size_t i=0; i<f.size(); i++) {
+        JobResult r = f[i].get();
+        printf("\n== %s\n%s", files[i], r.out.c_str());
+        if (r.rc) {
+            fprintf(stderr, " %s\n", r.err.c_str());
+            err = -2;
+        }
+    }
+    ex.dump();
+    return err;
+}
 
 int main(int ac, char* av[]) {
     if (ac <= 1) {
-        fprintf(stderr,"Usage:> $0 file_name.class\n");
+        fprintf(stderr,"Usage:> $0 [-t<level>] [-p] [-g] [-j<workers>] file_name.class\n");
         return -1;
     }
     forth_setup(send_to_console);
     java_setup(send_to_console);
 
+    int trace = 0, prof = 0, gc = 0, jobs = -1;
+    std::vector<const char*> files;
     for (int i=1; i<ac; i++) {
+        if (av[i][0]=='-' && av[i][1]=='t') {   /// trace level, 1:calls, 2:instructions, 3:stack
+            trace = atoi(&av[i][2]);
+            continue;
+        }
+        if (av[i][0]=='-' && av[i][1]=='p') {   /// profile opcodes and words
+            prof = 1;
+            continue;
+        }
+        if (av[i][0]=='-' && av[i][1]=='g') {   /// gc statistics at exit
+            gc = 1;
+            continue;
+        }
+        if (av[i][0]=='-' && av[i][1]=='j') {   /// job executor, 0: a worker per core
+            jobs = atoi(&av[i][2]);
+            continue;
+        }
+        if (jobs >= 0) {
+            files.push_back(av[i]);
+            continue;
+        }
     	if (!java_load(av[i])) {
     		fprintf(stderr, " Failed to load class file: %s\n", av[i]);
     		return -2;
     	}
     }
+    if (jobs >= 0) return run_jobs(jobs, files);
+
     printf("\neJ32 v1 staring...\n");
 
+    java_trace(trace);
+    java_profile(prof);
     java_run();
+    if (trace) java_trace_dump();
+    if (prof)  java_profile_dump();
+    if (gc)    java_gc_dump();
 
     printf("\n\neJ32 done.\n");
 
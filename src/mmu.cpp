@@ -1,12 +1,53 @@
-#include "mmu.h"
+#include "vm.h"      // gPool, gGC of the current VM
 
-Pool gPool;             /// global memory pool manager
+///
+/// FNV-1a string hash
+///
+static U32 fnv1a(const char *s) {
+    U32 h = 2166136261u;
+    while (*s) { h ^= (U8)*s++; h *= 16777619u; }
+    return h;
+}
+///
+/// dictionary hash index
+///   slot by name hash, entries with the same name are told apart by context
+///
+void Pool::hx_add(const char *name, IU ctx, IU pidx, IU ref) {
+    if (!hx_ok()) return;               /// too full, linear search from now on
+    U32 h = fnv1a(name);
+    int i = h & (HX_SZ - 1);
+    while (hx.v[i].ref != DATA_NA) i = (i + 1) & (HX_SZ - 1);
+    hx.v[i] = { (U16)(h >> 16), ctx, pidx, ref };
+    hx.max  = hx.idx++;
+}
+///
+/// find a word by name in context
+///   supr=true: search classes defined before ctx too (i.e. same as walking cls->lfa),
+///   a vocabulary search by load order, Java method refs use resolve_method
+///   latest definition wins, i.e. highest context then highest pmem index
+///
+IU Pool::hx_find(const char *name, IU ctx, IU pidx, bool supr) {
+    U32 h   = fnv1a(name);
+    U16 h16 = (U16)(h >> 16);
+    IU  mx  = DATA_NA, cx = 0;
+    for (int i = h & (HX_SZ - 1); hx.v[i].ref != DATA_NA; i = (i + 1) & (HX_SZ - 1)) {
+        HX &e = hx.v[i];
+        if (e.h != h16 || (supr ? e.ctx > ctx : e.ctx != ctx)) continue;
+        Word *w = (Word*)&pmem[e.ref];
+        if (strcmp(w->nfa(), name)) continue;
+        if (pidx!=DATA_NA && w->access!=ACL_BUILTIN && pidx!=e.pidx) continue;
+        if (mx==DATA_NA || e.ctx > cx || (e.ctx==cx && e.ref > mx)) {
+            mx = e.ref; cx = e.ctx;
+        }
+    }
+    return mx;
+}
 ///
 /// search for word following given linked list
 ///
 IU Pool::get_parm_idx(const char *parm) {
 	if (!parm) return DATA_NA;
-	IU pidx = find(parm, parm_root);
+	IU pidx = hx_ok() ? hx_find(parm, CTX_PARM, DATA_NA, false) : find(parm, parm_root);
 	if (pidx != DATA_NA) return pidx;  /// no cached entry found
 
     IU px = pmem.idx;                  /// store current param list index
@@ -14,12 +55,12 @@ IU Pool::get_parm_idx(const char *parm) {
     mem_u8(STRLEN(parm));              /// param list description length
     mem_u8(0);                         /// no access control
     mem_str(parm);                     /// inscribe param list description
+    hx_add(parm, CTX_PARM, DATA_NA, px);
 
     return parm_root = px;             /// adjust method root
 }
 IU Pool::find(const char *name, IU root, IU pidx) {
 	if (root==DATA_NA) return DATA_NA; /// no entry yet
-    yield();                           /// gives some cycles to main thread (ESP32)
     IU idx = root;
     U8 len = STRLEN(name);             /// get length first, speed up matching
     do {
@@ -36,29 +77,76 @@ IU Pool::find(const char *name, IU root, IU pidx) {
 /// return cls_obj if cls_name is NULL
 ///
 IU Pool::get_class(const char *cls_name) {
-    return cls_name ? find(cls_name, cls_root) : jvm_root;
+    if (!cls_name) return jvm_root;
+    return hx_ok() ? hx_find(cls_name, CTX_CLS, DATA_NA, false) : find(cls_name, cls_root);
 }
 ///
 /// return m_root if m_name is NULL
 ///
 IU Pool::get_method(const char *m_name, IU ctx, IU pidx, bool supr) {
-    Word *cls = (Word*)&pmem[ctx != DATA_NA ? ctx : cls_root];
+    if (ctx == DATA_NA) ctx = cls_root;
+    if (hx_ok()) return hx_find(m_name, ctx, pidx, supr);
+    Word *cls = (Word*)&pmem[ctx];
     IU mx = DATA_NA;
     while (cls) {
         mx = find(m_name, *(IU*)cls->pfa(PFA_CLS_VT), pidx);
         if (mx != DATA_NA || !supr) break;
         cls = (cls->lfa == DATA_NA) ? 0 : (Word*)&pmem[cls->lfa];
     }
-    yield();                       /// gives some cycles to main thread (ESP32)
     return mx;
 }
 ///
+/// Java method ref, declared in class cx or inherited from its super classes
+///
+IU Pool::resolve_method(const char *m_name, IU cx, IU pidx) {
+    while (cx != DATA_NA) {
+        Word *cls = (Word*)&pmem[cx];
+        IU   mx   = hx_ok()
+            ? hx_find(m_name, cx, pidx, false)
+            : find(m_name, *(IU*)cls->pfa(PFA_CLS_VT), pidx);
+        if (mx != DATA_NA) return mx;
+        cx = *(IU*)cls->pfa(PFA_CLS_SUPR);
+    }
+    return DATA_NA;
+}
+///
+/// virtual method lookup, one index into the indexed vtable of class cx
+///   the slot of mx is taken only when mx sits in it in cx or a super class
+///   of cx, i.e. mx is declared by an ancestor, otherwise mx is looked up
+///   by name and parameter list from cx up
+/// Note: returns mx itself when it has no slot or nothing is found
+///
+IU Pool::get_virtual(IU cx, IU mx) {
+    Word *w = (Word*)&pmem[mx];
+    IU   s  = *(IU*)w->pfa(PFA_VT_SLOT);
+    if (s == DATA_NA) return mx;
+    for (IU ax = cx; ax != DATA_NA; ax = *(IU*)((Word*)&pmem[ax])->pfa(PFA_CLS_SUPR)) {
+        IU *v = vtable(ax);
+        if (s >= v[0]) break;          /// super classes have fewer slots
+        if (v[1 + s] == mx) return vtable(cx)[1 + s];
+    }
+    IU rx = resolve_method(w->nfa(), cx, *(IU*)w->pfa(PFA_PARM_IDX));
+    return rx == DATA_NA ? mx : rx;
+}
+///
+/// field lookup from class cx up its super classes
+///
+IU Pool::get_field(const char *f_name, IU &cx) {
+    while (cx != DATA_NA) {
+        Word *cls = (Word*)&pmem[cx];
+        IU   fx   = find(f_name, *(IU*)cls->pfa(PFA_CLS_FLD));
+        if (fx != DATA_NA) return fx;
+        cx = *(IU*)cls->pfa(PFA_CLS_SUPR);
+    }
+    return DATA_NA;
+}
+///
 /// method, class constructor
 ///
 ///   Word Memory Format: shared between ucode, method, and class
 ///     |   word hdr     | str  |
-///     | 16b  |8b  | 8b | len  | 64/32b | 16b  |
-///     | LFA  |len |flag| name | xt     | parm |
+///     | 16b  |8b  | 8b | len  | 64/32b | 16b  | 16b  | 16b          |
+///     | LFA  |len |flag| name | xt     | parm | slot | jdx (Java)   |
 IU Pool::mem_hdr(IU &root, const char *nf, U8 flag) {
 	IU rx = pmem.idx;              /// capture current memory index
 	mem_iu(root);                  /// link to previous method
@@ -71,59 +159,229 @@ IU Pool::add_ucode(IU &m_root, const Method &vt, IU pidx) {
     mem_hdr(m_root, vt.name, vt.flag);
 	mem_pu((PU)vt.xt);             /// encode function pointer
 	mem_iu(pidx);                  /// parameter list index
+	mem_iu(DATA_NA);               /// vtable slot, set by add_vtable
     return m_root;
 };
-IU Pool::add_method(IU &m_root, const char *m_name, IU mjdx, IU pidx) {
-    mem_hdr(m_root, m_name, JAVA_FUNC);
+IU Pool::add_method(IU &m_root, const char *m_name, IU mjdx, IU pidx, IU jdx, U8 flag) {
+    mem_hdr(m_root, m_name, JAVA_FUNC | flag);
 	mem_pu((PU)mjdx);              /// encode function pointer
 	mem_iu(pidx);                  /// parameter list index
+	mem_iu(DATA_NA);               /// vtable slot, set by add_vtable
+	mem_iu(jdx);                   /// java class file the bytecode lives in
     return m_root;
 };
-IU Pool::add_class(const char *c_name, IU jdx, IU m_root, const char *supr, U16 cvsz, U16 ivsz) {
-	mem_hdr(cls_root, c_name, 0);  /// create class header
-	mem_iu(get_class(supr));       /// encode super class idx
+IU Pool::add_field(IU &f_root, const char *f_name, U8 flag, U8 type, IU off) {
+    mem_hdr(f_root, f_name, flag);
+    mem_iu(off);                   /// storage offset (bytes)
+    mem_u8(type);                  /// type descriptor
+    mem_u8(0);
+    return f_root;
+}
+IU Pool::add_class(const char *c_name, IU jdx, IU m_root, const char *supr, IU cvsz, IU ivsz, IU f_root) {
+	IU cx = mem_hdr(cls_root, c_name, 0);  /// create class header
+	hx_add(c_name, CTX_CLS, DATA_NA, cx);
+	for (IU mx = m_root; mx != DATA_NA; mx = ((Word*)&pmem[mx])->lfa) {
+	    Word *w = (Word*)&pmem[mx];    /// index methods under this class
+	    hx_add(w->nfa(), cx, *(IU*)w->pfa(PFA_PARM_IDX), mx);
+	}
+	IU sx = get_class(supr);
+	mem_iu(sx);                    /// encode super class idx
 	mem_iu(jdx);                   /// java class file index
 	mem_iu(m_root);                /// encode class vtable
     mem_iu(cvsz);                  /// cvsz - class variable size
     mem_iu(ivsz);                  /// ivsz - instance variable size
-    for (int i=0; i<cvsz; i+=sizeof(DU)) {	/// allocate static variables
+    IU vx = pmem.idx;
+    mem_iu(DATA_NA);               /// indexed vtable, filled below
+    mem_iu(f_root);                /// field list
+    mem_du(0);                     /// lock word, static synchronized methods
+    for (IU i=0; i<cvsz; i+=sizeof(DU)) {	/// allocate static variables
     	mem_du(0);
     }
+    *(IU*)&pmem[vx] = add_vtable(sx, m_root);
     return cls_root;               /// return head of class linked list (as context)
 }
 ///
+/// flattened vtable, super class slots copied then own methods
+///   an own method with the same name and parameter list takes over the
+///   inherited slot, otherwise it is given the next one
+/// Note: only methods with a parameter list (i.e. callable from Java) get slots
+///
+IU Pool::add_vtable(IU sx, IU m_root) {
+    IU *sv = sx==DATA_NA ? 0 : vtable(sx);
+    IU ns  = sv ? sv[0] : 0, n = ns;
+    for (IU mx = m_root; mx != DATA_NA; mx = ((Word*)&pmem[mx])->lfa) {
+        if (*(IU*)((Word*)&pmem[mx])->pfa(PFA_PARM_IDX) != DATA_NA) n++;
+    }
+    IU vx = pmem.idx;              /// [n, mx0, mx1, ...]
+    mem_iu(0);
+    for (IU i=0; i<n; i++) mem_iu(sv && i<ns ? sv[1 + i] : DATA_NA);
+    IU *v = (IU*)&pmem[vx];
+    n = ns;
+    for (IU mx = m_root; mx != DATA_NA; mx = ((Word*)&pmem[mx])->lfa) {
+        Word *w    = (Word*)&pmem[mx];
+        IU   pidx  = *(IU*)w->pfa(PFA_PARM_IDX);
+        if (pidx == DATA_NA) continue;
+        IU   s = 0;
+        while (s < ns) {           /// override an inherited slot?
+            Word *x = (Word*)&pmem[v[1 + s]];
+            if (*(IU*)x->pfa(PFA_PARM_IDX)==pidx && strcmp(x->nfa(), w->nfa())==0) break;
+            s++;
+        }
+        if (s == ns) s = n++;      /// new slot
+        v[1 + s] = mx;
+        *(IU*)w->pfa(PFA_VT_SLOT) = s;
+    }
+    v[0] = n;
+    return vx;
+}
+///
 /// class constructor
 ///
-void Pool::register_class(const char *name, const Method *vt, int vtsz, const char *supr, U16 cvsz, U16 ivsz) {
+void Pool::register_class(const char *name, const Method *vt, int vtsz, const char *supr, IU cvsz, IU ivsz, IU f_root) {
     /// encode vtable
     IU m_root = DATA_NA;
     for (int i=0; i<vtsz; i++) {
     	IU pidx = get_parm_idx(vt[i].parm);  /// cache parameter list string
         add_ucode(m_root, vt[i], pidx);      /// create microcode, TODO: with ROM
     }
-    if (vtsz) add_class(name, 0, m_root, supr, cvsz, ivsz);
+    if (vtsz) add_class(name, 0, m_root, supr, cvsz, ivsz, f_root);
+}
+///
+/// heap free lists
+///   a block of the same size class is taken first (O(1)), a larger block
+///   is split only after the top of heap is used up, the rest of it goes
+///   back to its own class
+///
+void Pool::obj_free(IU ox) {
+    Obj *o   = OBJ(ox);
+    int c    = fl_cls(OBJ_SPAN(o));
+    o->lfa   = fl[c];
+    o->n     = 0;
+    o->atype = T_FREE;
+    o->flag  = 0;
+    fl[c]    = ox;
+    fl_sz   += OBJ_SPAN(o);
+}
+IU Pool::obj_fit(IU span) {
+    int c = fl_cls(span);
+    if (c < FL_CLS && fl[c] != DATA_NA) {          /// same size class
+        IU ox = fl[c];
+        fl[c]  = OBJ(ox)->lfa;
+        fl_sz -= span;
+        return ox;
+    }
+    if (obj_room(span)) return DATA_NA;
+    for (int i = c < FL_CLS ? c + 1 : FL_CLS; i <= FL_CLS; i++) {
+        for (IU *p = &fl[i]; *p != DATA_NA; p = &OBJ(*p)->lfa) {
+            IU ox  = *p;
+            IU fsp = OBJ_SPAN(OBJ(ox));
+            if (fsp != span && fsp < span + sizeof(Obj)) {   /// rest cannot hold a header
+                if (i < FL_CLS) break;
+                continue;
+            }
+            *p     = OBJ(ox)->lfa;
+            fl_sz -= fsp;
+            if (fsp > span) {
+                OBJ(ox + span)->sz = fsp - span - sizeof(Obj);
+                obj_free(ox + span);
+            }
+            return ox;
+        }
+    }
+    return DATA_NA;
+}
+///
+/// thread-local allocation buffers
+///
+bool Pool::tlab_refill(Tlab &tl) {
+    tlab_retire(tl);
+    IU ox = obj_fit(TLAB_SZ);                      /// large free block
+    if (ox == DATA_NA) {                           /// top of heap
+        if (!obj_room(TLAB_SZ)) return false;
+        while (heap.idx & (sizeof(DU) - 1)) obj_u8(0);
+        ox = heap.idx;
+        heap.idx += TLAB_SZ;
+        if (heap.idx > heap.max) heap.max = heap.idx;
+    }
+    memset(&heap[ox], 0, TLAB_SZ);                 /// headers and fields start zeroed
+    tl.top = ox;
+    tl.end = ox + TLAB_SZ;
+    tlab_n++;
+    return true;
+}
+void Pool::tlab_retire(Tlab &tl) {
+    if (tl.root != DATA_NA) {
+        OBJ(tl.last)->lfa = obj_root;
+        obj_root = tl.root;
+    }
+    if (tl.top < tl.end) {
+        OBJ(tl.top)->sz = tl.end - tl.top - sizeof(Obj);
+        obj_free(tl.top);
+    }
+    tl.top  = tl.end  = 0;
+    tl.root = tl.last = DATA_NA;
 }
 ///
 /// new object instance
+///   small objects come from the TLAB of the calling thread, others and
+///   those which no TLAB can be refilled for from the shared heap
 ///
-IU Pool::obj_hdr(IU n, U16 sz) {
+IU Pool::obj_hdr(U8 atype, IU n, IU sz, Tlab *tl) {
+    IU span = ALIGN_DU(sizeof(Obj) + sz);
+    if (tl && span <= TLAB_OBJ) {
+        IU ox = tl->bump(span);
+        if (ox == DATA_NA && tlab_refill(*tl)) ox = tl->bump(span);
+        if (ox != DATA_NA) {            /// flag, lock and data already zero
+            Obj *o = OBJ(ox);
+            o->lfa   = tl->root;
+            o->n     = n;
+            o->atype = atype;
+            o->sz    = sz;
+            if (tl->root == DATA_NA) tl->last = ox;
+            return tl->root = ox;
+        }
+    }
+    IU ox   = obj_fit(span);
+    if (ox == DATA_NA && !obj_room(span)) {        /// out of heap
+        gGC.sweep();                               /// dead blocks to their class
+        ox = obj_fit(span);
+        if (ox == DATA_NA && !obj_room(span)) {
+            gGC.collect();                         /// too fragmented, compact
+            ox = obj_fit(span);
+        }
+        if (ox == DATA_NA && !obj_room(span)) throw "ERR: heap full";
+    }
+    if (ox != DATA_NA) {                /// reused block, list order is not kept
+        Obj *o = OBJ(ox);
+        o->lfa   = obj_root;
+        o->n     = n;
+        o->atype = atype;
+        o->flag  = 0;
+        o->sz    = sz;
+        o->lock  = 0;
+        memset(o->data, 0, sz);
+        return obj_root = ox;
+    }
+    while (heap.idx & (sizeof(DU) - 1)) obj_u8(0);  /// align to DU
 	IU oid  = heap.idx;             /// keep object index
-    obj_iu(obj_root);				/// encode object linked list root
-    obj_iu(n);                      /// encode value
-    obj_allot(sz);
+    obj_allot(sizeof(Obj) + sz);    /// zeroed header and data
+    Obj *o  = OBJ(oid);
+    o->lfa   = obj_root;            /// object linked list root
+    o->n     = n;                   /// class or array length
+    o->atype = atype;               /// element type
+    o->sz    = sz;                  /// data size
     return obj_root = oid;
 }
-IU Pool::add_obj(IU cx) {
+IU Pool::add_obj(IU cx, Tlab *tl) {
     Word *w   = (Word*)&pmem[cx];	/// get object class pointer
-    U16  ivsz = *(U16*)w->pfa(PFA_CLS_IVSZ);
-    return obj_hdr(cx, ivsz);       /// encode class reference with ivsz allocation
+    IU   ivsz = *(IU*)w->pfa(PFA_CLS_IVSZ);
+    return obj_hdr(T_OBJ, cx, ivsz, tl);  /// encode class reference with ivsz allocation
 }
 ///
-/// new Array storage
-/// Note: atype is ignored for now, TODO:
+/// new Array storage, elements at their natural width
 ///
-IU Pool::add_array(U8 atype, IU n) {
-	return obj_hdr(n, sizeof(DU) * n);  /// allocate array w length (max 64K)
+IU Pool::add_array(U8 atype, IU n, Tlab *tl) {
+	return obj_hdr(atype, n, T_SIZE(atype) * n, tl);  /// allocate array w length
 }
 
 void Pool::build_op_lookup() {
@@ -145,4 +403,5 @@ void Pool::colon(const char *name, IU ctx) {
     Word *w  = (Word*)&pmem[ctx];	    /// get context (class/vocabulary)
     IU   *vt = (IU*)w->pfa(PFA_CLS_VT); /// pointer to method root
     mem_hdr(*vt, name, FORTH_FUNC);     /// create word header
+    hx_add(name, ctx, DATA_NA, *vt);
 }
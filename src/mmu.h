@@ -2,6 +2,64 @@
 #define NANOJVM_MMU_H
 #include "core.h"
 
+///
+/// dictionary hash index entry (open addressing, linear probing)
+///
+#define CTX_CLS     (DATA_NA - 1) /** context for class names     */
+#define CTX_PARM    (DATA_NA - 2) /** context for parameter lists */
+struct HX {
+    U16 h;                        /// upper bits of name hash (quick reject)
+    IU  ctx;                      /// context (class) index or CTX_* marker
+    IU  pidx;                     /// parameter list index
+    IU  ref  = DATA_NA;           /// word index in pmem, DATA_NA: empty slot
+};
+///
+/// object and array header (heap)
+///   objects start DU aligned, narrow array elements and fields are packed
+///
+#define T_OBJ       0             /** object instance, not an array    */
+#define T_REF       1             /** array of references (anewarray)  */
+#define T_BOOLEAN   4             /** newarray atype                   */
+#define T_CHAR      5
+#define T_FLOAT     6
+#define T_DOUBLE    7
+#define T_BYTE      8
+#define T_SHORT     9
+#define T_INT       10
+#define T_LONG      11
+#define T_FREE      0xff          /** free block, on a size class list  */
+#define T_SIZE(t)   ((t)==T_REF ? sizeof(DU) : (1 << ((t) & 3)))  /** element size */
+struct Obj {                      /// 12-byte header, 20 with 32-bit IU
+    IU  lfa;                      /// link to previous object
+    IU  n;                        /// object: class, array: length
+    IU  sz;                       /// data size in bytes
+    U8  atype;                    /// T_OBJ or array element type
+    U8  flag;                     /// reserved
+    U32 lock;                     /// monitor lock word, 0: unlocked
+    U8  data[];                   /// fields or array elements
+};
+#define OBJ_HDR (ALIGN_DU(sizeof(Obj)) / sizeof(DU))  /** header cells, smallest span */
+///
+/// thread-local allocation buffer, a zeroed heap chunk owned by one thread
+///   small objects are bumped from top without touching Pool, the chunk is
+///   refilled from the top of heap or a large free block
+///   objects are linked within the buffer and spliced into obj_root when
+///   the buffer is retired (refill, gc, thread exit), the unused rest
+///   becomes a free block, i.e. the heap stays walkable for gc
+///
+struct Tlab {
+    IU top  = 0;                  /// next object
+    IU end  = 0;                  /// end of buffer, top == end: empty
+    IU root = DATA_NA;            /// newest object in buffer
+    IU last = DATA_NA;            /// oldest object in buffer
+    IU bump(IU span) {            /// rest is 0 or can hold a free block header
+        IU r = end - top;
+        if (span != r && span + sizeof(Obj) > r) return DATA_NA;
+        IU ox = top;
+        top  += span;
+        return ox;
+    }
+};
 struct KV {
 	IU key;                       /// Java class file index
 	IU ctx;						  /// context (class/vocabulary) index
@@ -9,6 +67,19 @@ struct KV {
 	IU nparm;                     /// optional parameter count
 };
 ///
+/// inline cache of one invokevirtual call site
+///   n <= IC_WAYS: mono/polymorphic, receiver class => method
+///   n >  IC_WAYS: megamorphic, vtable index on every call
+///
+struct IC {
+    IU key;                       /// call site (opcode address in class file)
+    IU ctx;                       /// context (class) of the call site
+    IU vi;                        /// gPool.vt index of statically resolved method
+    U8 n;                         /// receiver classes seen
+    IU cx[IC_WAYS];               /// receiver class
+    IU mx[IC_WAYS];               /// method to dispatch for cx
+};
+///
 /// Memory Pool Manager
 /// Note:
 ///    ucode is fused into vt for now, it can stay in ROM
@@ -16,7 +87,6 @@ struct KV {
 struct Pool {
     List<U8, PMEM_SZ>   pmem;     /// parameter memory
     List<U8, HEAP_SZ>   heap;	  /// object space
-    List<DU, RS_SZ>     rs;		  /// global return stack
     ///
     /// JIT lookup tables
     ///
@@ -24,11 +94,13 @@ struct Pool {
     List<KV, VT_LU_SZ>  vt;       /// java method lookup
     List<KV, CV_LU_SZ>  cv;       /// class variable lookup
     List<KV, IV_LU_SZ>  iv;       /// instance variable lookup
+    List<IC, IC_LU_SZ>  ic;       /// invokevirtual inline caches
+    List<HX, HX_SZ>     hx;       /// dictionary hash index (idx = entry count)
 
     template<typename T>
     IU  lookup(T &a, IU j, IU ctx) {
-    	for (IU i=0; i<a.idx; i++) if (a[i].key == j && a[i].ctx == ctx) {
-    		LOG(" =>$"); LOX(i);
+    	for (int i=0; i<a.idx; i++) if (a[i].key == j && a[i].ctx == ctx) {
+    		DLOG(" =>$"); DLOX(i);
     		return i;
     	}
     	return DATA_NA;
@@ -40,29 +112,59 @@ struct Pool {
     IU jvm_root  = DATA_NA;       /// JVM methods linked list
     IU cls_root  = DATA_NA;       /// Class linked list
     IU obj_root  = DATA_NA;       /// Object linked list
+    ///
+    /// heap free blocks (T_FREE, linked by lfa, filled by gc)
+    ///   fl[i], i < FL_CLS: blocks spanning (i+OBJ_HDR) cells, exact fit
+    ///   fl[FL_CLS]:        larger blocks, first fit
+    ///
+    IU  fl[FL_CLS + 1];
+    U32 fl_sz    = 0;             /// bytes in free blocks
+    U32 tlab_n   = 0;             /// TLAB refills
+
+    Pool() { obj_du(0); fl_reset(); }  /// heap[0] reserved, 0 is the null reference
 
     IU   get_parm_idx(const char *parm);
     IU   find(const char *m_name, IU root, IU pidx=DATA_NA);
+    ///
+    /// dictionary hash index, linked lists are kept for words/debugging
+    ///
+    bool hx_ok() { return hx.idx < (HX_SZ * 3 / 4); }  /// linear search when too full
+    void hx_add(const char *name, IU ctx, IU pidx, IU ref);
+    IU   hx_find(const char *name, IU ctx, IU pidx, bool supr);
     IU   get_class(const char *cls_name);
     IU   get_method(const char *m_name, IU ctx=DATA_NA, IU pidx=DATA_NA, bool supr=true);
+    IU   resolve_method(const char *m_name, IU cx, IU pidx);  /// cx then its super classes
+    IU   get_virtual(IU cx, IU mx);   /// method mx as overridden in class cx
+    IU   *vtable(IU cx) { return (IU*)&pmem[*(IU*)((Word*)&pmem[cx])->pfa(PFA_CLS_VTX)]; }
+    IU   get_field(const char *f_name, IU &cx);  /// cx updated to declaring class
     ///
     /// dictionary builder (use gPool.pmem use pmem for Forth Dictionary)
     ///
     IU   mem_hdr(IU &root, const char *nf, U8 flag);
     IU   add_ucode(IU &m_root, const Method &vt, IU pidx);
-    IU   add_method(IU &m_root, const char *m_name, IU mjdx, IU pidx);
-    IU   add_class(const char *c_name, IU jdx, IU m_root, const char *supr, U16 cvsz, U16 ivsz);
-    void register_class(const char *name, const Method *vt, int vtsz, const char *supr = 0, U16 cvsz=0, U16 ivsz=0);
+    IU   add_method(IU &m_root, const char *m_name, IU mjdx, IU pidx, IU jdx, U8 flag=0);
+    IU   add_field(IU &f_root, const char *f_name, U8 flag, U8 type, IU off);
+    IU   add_class(const char *c_name, IU jdx, IU m_root, const char *supr, IU cvsz, IU ivsz, IU f_root=DATA_NA);
+    IU   add_vtable(IU sx, IU m_root);
+    void register_class(const char *name, const Method *vt, int vtsz, const char *supr = 0, IU cvsz=0, IU ivsz=0, IU f_root=DATA_NA);
     ///
     /// new object and array instance (use gPool.heap for object space)
     ///
-    IU   obj_hdr(IU n, U16 sz);
-    IU   add_obj(IU cx);
-    IU   add_array(U8 atype, IU n);
+    IU   obj_hdr(U8 atype, IU n, IU sz, Tlab *tl=0);
+    int  fl_cls(IU span)   { IU i = span / sizeof(DU) - OBJ_HDR; return i < FL_CLS ? i : FL_CLS; }
+    void fl_reset()        { for (int i=0; i<=FL_CLS; i++) fl[i] = DATA_NA; fl_sz = 0; }
+    bool obj_room(IU span) { return ALIGN_DU(heap.idx) + span <= HEAP_SZ; }
+    IU   obj_fit(IU span);        /// free block for span, DATA_NA: use top of heap
+    void obj_free(IU ox);         /// block back to its size class
+    bool tlab_refill(Tlab &tl);   /// new buffer, false: heap needs gc
+    void tlab_retire(Tlab &tl);   /// objects to obj_root, rest to free list
+    IU   add_obj(IU cx, Tlab *tl=0);
+    IU   add_array(U8 atype, IU n, Tlab *tl=0);
     void obj_u8(U8 b)    { heap.push(b); }
     void obj_iu(IU i)    { heap.push((U8*)&i, sizeof(IU)); }
     void obj_du(DU v)    { heap.push((U8*)&v, sizeof(DU)); }
-    void obj_allot(IU n) { for (int i=0; i<n; i+=sizeof(DU)) obj_du(0); }
+    void obj_u32(U32 v)  { heap.push((U8*)&v, sizeof(U32)); }
+    void obj_allot(IU n) { for (IU i=0; i<n; i++) obj_u8(0); }
     ///
     /// compiler methods
     ///
@@ -76,12 +178,14 @@ struct Pool {
     void mem_str(const char *s) { int sz = STRLEN(s); pmem.push((U8*)s,  sz); }
     void mem_op(U16 i) { mem_iu(op[i]); }
 };
-extern Pool gPool;
 ///
 /// macros for parameter memory access
 ///
 #define WORD(a)   ((Word*)&gPool.pmem[a])
-#define OBJ(a)    ((Word*)&gPool.heap[a])
+#define OBJ(a)    ((Obj*)&gPool.heap[a])
+#define OBJ_CX(a) (OBJ(a)->n)                   /** class of an object             */
+#define OBJ0      sizeof(DU)                    /** first object, heap[0] is null   */
+#define OBJ_SPAN(o) ALIGN_DU(sizeof(Obj) + (o)->sz) /** object start to next object */
 #define HERE      (gPool.pmem.idx)         /** current parameter memory index           */
 #endif // NANOJVM_MMU_H
 
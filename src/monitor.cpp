@@ -0,0 +1,115 @@
+#include "monitor.h"
+#include "thread.h"     // Thread
+#include "task.h"       // task_block, task_wake
+
+#define ME(t)           ((U32)(t).tid + 1)
+#define TBIT(t)         (1u << (t).tid)
+
+static U32  ld(U32 *p)  { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+static void st(U32 *p, U32 v) { __atomic_store_n(p, v, __ATOMIC_RELEASE); }
+static bool cas(U32 *p, U32 o, U32 n) {
+    return __atomic_compare_exchange_n(p, &o, n, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+bool Monitors::inflate(U32 *lw, U32 v) {
+    int i = 0;
+    while (i < MON_SZ && m[i].used) i++;
+    if (i == MON_SZ) throw "ERR: monitor table full";
+    Monitor &x = m[i];
+    x.used  = 1;
+    x.owner = v & LK_TID;
+    x.count = (v & LK_CNT) / LK_ONE;
+    x.entry = x.wset = 0;
+    if (!cas(lw, v, LK_FAT | i)) {   /// changed meanwhile, caller retries
+        x.used = 0;
+        return false;
+    }
+    inflated++;
+    return true;
+}
+Monitor &Monitors::owned(Thread &t, U32 *lw) {
+    for (;;) {
+        U32 v = ld(lw);
+        if (v & LK_FAT) {
+            Monitor &x = m[v & ~LK_FAT];
+            if (x.owner != ME(t)) break;
+            return x;
+        }
+        if ((v & LK_TID) != ME(t)) break;
+        inflate(lw, v);
+    }
+    throw "ERR: monitor not owned";
+}
+void Monitors::wake(U32 &set) {
+    int i = 0;
+    while (!(set & (1u << i))) i++;  /// lowest tid first
+    set &= ~(1u << i);
+    task_wake(i);
+}
+void Monitors::enter(Thread &t, U32 *lw) {
+    for (;;) {
+        U32 v = ld(lw);
+        if (!v) {                    /// unlocked, the fast path
+            if (cas(lw, 0, ME(t))) return;
+            continue;
+        }
+        if (!(v & LK_FAT)) {
+            if ((v & LK_TID) == ME(t) && (v & LK_CNT) != LK_CNT) {
+                if (cas(lw, v, v + LK_ONE)) return;
+            }
+            else inflate(lw, v);     /// contended or count overflow
+            continue;
+        }
+        Monitor &x = m[v & ~LK_FAT];
+        if (!x.owner)          { x.owner = ME(t); return; }
+        if (x.owner == ME(t))  { x.count++;       return; }
+        x.entry |= TBIT(t);
+        blocked++;
+        task_block(t);               /// until the owner leaves
+    }
+}
+void Monitors::leave(Thread &t, U32 *lw) {
+    for (;;) {
+        U32 v = ld(lw);
+        if (!(v & LK_FAT)) {
+            if ((v & LK_TID) != ME(t)) throw "ERR: monitor not owned";
+            if (cas(lw, v, (v & LK_CNT) ? v - LK_ONE : 0)) return;
+            continue;                /// inflated by a contender meanwhile
+        }
+        Monitor &x = m[v & ~LK_FAT];
+        if (x.owner != ME(t)) throw "ERR: monitor not owned";
+        if (x.count) { x.count--; return; }
+        x.owner = 0;
+        if (x.entry) wake(x.entry);
+        else if (!x.wset) {          /// nobody around, deflate
+            st(lw, 0);
+            x.used = 0;
+        }
+        return;
+    }
+}
+void Monitors::wait(Thread &t, U32 *lw) {
+    Monitor &x = owned(t, lw);
+    U32 n   = x.count;               /// release all entries
+    x.owner = 0;
+    x.count = 0;
+    x.wset |= TBIT(t);
+    if (x.entry) wake(x.entry);
+    task_block(t);                   /// until notified
+    enter(t, lw);
+    U32 v = ld(lw);                  /// restore entries, lock may be thin again
+    if (v & LK_FAT) m[v & ~LK_FAT].count = n;
+    else st(lw, ME(t) + n * LK_ONE);
+}
+void Monitors::notify(Thread &t, U32 *lw, bool all) {
+    U32 v = ld(lw);
+    if (!(v & LK_FAT)) {             /// thin, nobody waits
+        if ((v & LK_TID) != ME(t)) throw "ERR: monitor not owned";
+        return;
+    }
+    Monitor &x = owned(t, lw);
+    while (x.wset) {
+        wake(x.wset);                /// it enters again once we leave
+        if (!all) break;
+    }
+}
@@ -0,0 +1,51 @@
+///
+/// @brief nanoJVM object monitors (thin locks)
+/// Note:
+///   * a 32-bit lock word per object (Obj.lock) and per class (static
+///     synchronized methods), 0: unlocked
+///   * thin lock:  [count:23][owner tid+1:8], taken and released by CAS,
+///     recursive entry bumps count, no monitor is allocated
+///   * inflated:   LK_FAT | monitor index, when a second thread contends,
+///     on wait() or when count overflows; the last exit with nobody
+///     waiting deflates it back to 0
+///   * blocked threads park in task_block(), i.e. the scheduler (green) or
+///     off the VM lock (native) runs others
+///   * callers keep the object pinned (on a stack) while a call may block
+///
+#ifndef NANOJVM_MONITOR_H
+#define NANOJVM_MONITOR_H
+#include "core.h"
+
+#define LK_FAT      0x80000000    /** inflated, low bits: monitor index */
+#define LK_TID      0x000000ff    /** thin: owner tid+1                 */
+#define LK_ONE      0x00000100    /** thin: one recursive entry         */
+#define LK_CNT      0x7fffff00    /** thin: recursive entries           */
+
+struct Monitor {
+    U8   used;                    /// bound to a lock word
+    U8   owner;                   /// tid+1 of owner, 0: free
+    U32  count;                   /// recursive entries after the first
+    U32  entry;                   /// threads blocked entering, bit per tid
+    U32  wset;                    /// threads in wait(), bit per tid
+};
+struct Monitors {
+    Monitor m[MON_SZ];            /// inflated monitors
+    ///
+    /// statistics
+    ///
+    U32  inflated = 0;            /// thin locks inflated
+    U32  blocked  = 0;            /// times a thread blocked entering
+
+    Monitors() { memset(m, 0, sizeof(m)); }
+
+    void enter(Thread &t, U32 *lw);
+    void leave(Thread &t, U32 *lw);
+    void wait(Thread &t, U32 *lw);                 /// Object.wait()
+    void notify(Thread &t, U32 *lw, bool all);     /// Object.notify(), notifyAll()
+
+private:
+    bool    inflate(U32 *lw, U32 v);  /// thin lock word v to a monitor
+    Monitor &owned(Thread &t, U32 *lw);   /// inflated monitor held by t
+    void    wake(U32 &set);           /// resume one thread of set
+};
+#endif // NANOJVM_MONITOR_H
@@ -0,0 +1,85 @@
+#include "profile.h"
+#include "ucode.h"
+
+extern Ucode uCode;
+
+U32 Profiler::clock() {
+#if ARDUINO
+    return (U32)micros();
+#else
+    return (U32)chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+#endif // ARDUINO
+}
+///
+/// accumulate one word call, linear probing on pmem index
+///
+void Profiler::call(IU mx, U32 t0) {
+    U32 dt = clock() - t0;
+    for (int i = 0, h = mx; i < PROF_SZ; i++, h++) {
+        ProfRec &r = m[h & (PROF_SZ - 1)];
+        if (r.mx == DATA_NA) r.mx = mx;
+        if (r.mx == mx) { r.n++; r.t += dt; return; }
+    }
+    lost++;
+}
+void Profiler::clear() {
+    for (int i = 0; i < 256; i++) { op_n[i] = 0; op_t[i] = 0; }
+    for (int i = 0; i < PROF_SZ; i++) m[i] = ProfRec();
+    lost = 0;
+}
+///
+/// right-aligned unsigned decimal, at least one space in front
+///
+static void _col(U64 v, int w) {
+    int d = 1;
+    for (U64 x = v; x >= 10; x /= 10) d++;
+    do CHR(' '); while (--w > d);
+    LOU(v);
+}
+///
+/// select top entries by accumulated time (insertion into a short list)
+///
+static int _top(U64 *t, int n, int *idx, int top) {
+    int k = 0;
+    for (int i = 0; i < n; i++) {
+        if (!t[i]) continue;
+        if (k == top && t[idx[k - 1]] >= t[i]) continue;  /// not in the list
+        int j = k < top ? k++ : k - 1;                     /// slot to fill
+        while (j > 0 && t[idx[j - 1]] < t[i]) { idx[j] = idx[j - 1]; j--; }
+        idx[j] = i;
+    }
+    return k;
+}
+void Profiler::dump(int top) {
+    int idx[PROF_SZ];
+    if (top > PROF_SZ) top = PROF_SZ;
+#if ARDUINO
+    const char *unit = "us";
+#else
+    const char *unit = "ns";
+#endif // ARDUINO
+    LOG("\nprofile: opcodes (time in "); LOG(unit); LOG(", inclusive)");
+    LOG("\n     count          time       avg  op");
+    int k = _top(op_t, 256, idx, top);
+    for (int i = 0; i < k; i++) {
+        U8 op = (U8)idx[i];
+        LOG("\n"); _col(op_n[op], 10); _col(op_t[op], 14); _col(op_t[op] / op_n[op], 10);
+        LOG("  "); LOX2(op); LOG(" ");
+        LOG(op < uCode.vtsz ? uCode.vt[op].name : "?");
+        yield();
+    }
+    U64 wt[PROF_SZ];
+    for (int i = 0; i < PROF_SZ; i++) wt[i] = m[i].mx == DATA_NA ? 0 : m[i].t;
+    LOG("\nprofile: words (time in "); LOG(unit); LOG(", inclusive)");
+    LOG("\n     count          time       avg  word");
+    k = _top(wt, PROF_SZ, idx, top);
+    for (int i = 0; i < k; i++) {
+        ProfRec &r = m[idx[i]];
+        LOG("\n"); _col(r.n, 10); _col(r.t, 14); _col(r.t / r.n, 10);
+        LOG("  "); LOX4(r.mx); LOG(" "); LOG(WORD(r.mx)->nfa());
+        yield();
+    }
+    if (lost) { LOG("\n  lost="); LOU(lost); }
+    LOG("\n");
+}
@@ -0,0 +1,50 @@
+///
+/// @brief nanoJVM execution profiler
+/// Note:
+///   * counts and inclusive time per JVM opcode and per dictionary word
+///     (Java method, Forth word or native), keyed by pmem index from dispatch
+///   * opcodes are profiled on the reference engine only, java_call leaves
+///     the direct-threaded engine while profiling is on
+///   * compiled out with ENABLE_PROFILE=0, one branch per hook when off
+///
+#ifndef NANOJVM_PROFILE_H
+#define NANOJVM_PROFILE_H
+#include "core.h"
+
+struct ProfRec {              /// per word record
+    IU  mx = DATA_NA;         /// word index in pmem, DATA_NA: empty slot
+    U32 n  = 0;               /// number of calls
+    U64 t  = 0;               /// accumulated time (inclusive)
+};
+struct Profiler {
+    bool    on   = false;     /// profiling enabled
+    U32     lost = 0;         /// calls not recorded (table full)
+    U32     *op_n;            /// opcode execution counts
+    U64     *op_t;            /// opcode accumulated time (inclusive)
+    ProfRec *m;               /// word table (open addressing)
+
+    Profiler() {
+        op_n = new U32[256];
+        op_t = new U64[256];
+        m    = new ProfRec[PROF_SZ];
+        clear();
+    }
+    ~Profiler() { delete[] op_n; delete[] op_t; delete[] m; }
+
+    static U32 clock();       /// free running timer (ns on host, us on device)
+    void op(U8 op, U32 t0)   { op_n[op]++; op_t[op] += clock() - t0; }
+    void call(IU mx, U32 t0);
+    void clear();
+    void dump(int top=20);    /// sorted by accumulated time, top n of each table
+};
+
+#if ENABLE_PROFILE
+#define PROFILE(rec, key, stmt) \
+    if (gProf.on) { U32 _t0 = Profiler::clock(); stmt; gProf.rec(key, _t0); } \
+    else stmt
+#define PROF_ON         (gProf.on)
+#else
+#define PROFILE(rec, key, stmt) stmt
+#define PROF_ON         false
+#endif // ENABLE_PROFILE
+#endif // NANOJVM_PROFILE_H
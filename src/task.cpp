@@ -0,0 +1,415 @@
+///
+/// @brief nanoJVM threads, scheduler, VM lock and java/lang/Thread natives
+///
+#include "ucode.h"
+#include "task.h"
+#include "gc.h"
+#if !ARDUINO
+#if GREEN_THREAD
+#include <ucontext.h>
+#else
+#include <mutex>
+#include <condition_variable>
+#endif // GREEN_THREAD
+#endif // !ARDUINO
+///
+/// java/lang/Thread instance layout (ivsz = 2 cells)
+///
+#define THR_TARGET(ox)  (*(DU*)OBJ(ox)->data)                  /** Runnable or 0   */
+#define THR_ID(ox)      (*(DU*)(OBJ(ox)->data + sizeof(DU)))   /** serial, 0: new  */
+///
+/// thread states
+///
+enum { TS_FREE=0, TS_RUN, TS_READY, TS_SLEEP, TS_BLOCK, TS_DONE };
+///
+/// thread table, [0] is the main thread
+///
+struct Task {
+    Thread       *t   = 0;        /// VM thread, 0: free slot (main: not used)
+    VM           *vm  = 0;        /// VM the thread runs in
+    IU           mx   = DATA_NA;  /// run() as seen by the receiver class
+    U32          id   = 0;        /// serial kept in the Thread object
+    U8           st   = TS_FREE;
+    volatile bool woke = false;   /// task_wake came, consumed by task_block
+#if GREEN_THREAD
+    int          join = -1;       /// slot waited for (TS_BLOCK)
+    U32          wake = 0;        /// millis() to wake at (TS_SLEEP)
+#if ARDUINO
+    TaskHandle_t      h  = 0;
+    SemaphoreHandle_t go = 0;     /// baton, the task runs while it holds it
+#else
+    ucontext_t   uc;              /// saved registers
+    U8           *stk = 0;        /// native stack
+#endif // ARDUINO
+#else
+#if ARDUINO
+    TaskHandle_t h    = 0;
+#else
+    thread       os;
+#endif // ARDUINO
+#endif // GREEN_THREAD
+};
+///
+/// thread table and scheduler of a VM
+///
+#define RQ_SZ   (TASK_SZ + 1)
+struct Sched {
+    Task task[TASK_SZ + 1];
+    U32  serial = 0;
+#if GREEN_THREAD
+    int  cur = 0;                         /// running slot
+    int  rq[RQ_SZ], rh = 0, rn = 0;       /// ready queue, head, count
+    int  sq[RQ_SZ], sn = 0;               /// sleep queue, count
+#elif ARDUINO
+    SemaphoreHandle_t mx = 0;             /// VM lock
+#else
+    mutex              mx;                /// guards tickets, owner and done states
+    condition_variable cv;                /// ticket served or a thread finished
+    U32                next  = 0;
+    U32                serve = 0;
+    thread::id         owner;
+#endif // GREEN_THREAD
+};
+#define S       (*gVM->sched)             /** scheduler of the current VM */
+
+Sched *task_new()          { return new Sched; }
+void  task_free(Sched *s)  { delete s; }
+static void _body(Task &k);
+
+#if GREEN_THREAD
+///
+/// green threads, M:1 scheduler
+///   ready queue: FIFO ring of slots
+///   sleep queue: slots sorted by wake time, earliest first
+///
+
+#if ARDUINO
+///
+/// device: a FreeRTOS task per thread, but only the baton holder runs
+///
+static void _switch(int from, int to) {
+    xSemaphoreGive(S.task[to].go);
+    xSemaphoreTake(S.task[from].go, portMAX_DELAY);
+}
+static void _leave(int to) { xSemaphoreGive(S.task[to].go); vTaskDelete(NULL); }
+static void _entry(void *p) {
+    Task &k = *(Task*)p;
+    xSemaphoreTake(k.go, portMAX_DELAY);   /// wait for first turn
+    _body(k);
+}
+static void _os_start(Task &k) {
+    if (!S.task[0].go) S.task[0].go = xSemaphoreCreateBinary();
+    k.go = xSemaphoreCreateBinary();
+    xTaskCreate(_entry, "jthread", TASK_STACK, &k, uxTaskPriorityGet(NULL), &k.h);
+}
+static void _os_reap(Task &k) { vSemaphoreDelete(k.go); k.go = 0; k.h = 0; }
+#else
+///
+/// host: ucontext, all threads on the calling native thread
+///
+static void _switch(int from, int to) { swapcontext(&S.task[from].uc, &S.task[to].uc); }
+static void _leave(int to)            { setcontext(&S.task[to].uc); }
+static void _entry(int i)             { _body(S.task[i]); }
+static void _os_start(Task &k) {
+    k.stk = new U8[TASK_STACK];
+    getcontext(&k.uc);
+    k.uc.uc_stack.ss_sp   = k.stk;
+    k.uc.uc_stack.ss_size = TASK_STACK;
+    k.uc.uc_link          = 0;
+    makecontext(&k.uc, (void(*)())_entry, 1, (int)(&k - S.task));
+}
+static void _os_reap(Task &k) { delete[] k.stk; k.stk = 0; }
+#endif // ARDUINO
+
+void vm_acquire() {}                       /// one thread runs at a time anyway
+bool vm_release() { return false; }
+
+static void _ready(int i) {
+    S.task[i].st = TS_READY;
+    S.rq[(S.rh + S.rn++) % RQ_SZ] = i;
+}
+static void _timers() {                    /// move due sleepers to ready queue
+    U32 now = millis();
+    while (S.sn && (S32)(S.task[S.sq[0]].wake - now) <= 0) {
+        int i = S.sq[0];
+        for (int n = 1; n < S.sn; n++) S.sq[n - 1] = S.sq[n];
+        S.sn--;
+        _ready(i);
+    }
+}
+static int _next() {                       /// next ready slot, idle till a timer is due
+    for (;;) {
+        _timers();
+        if (S.rn) {
+            int i = S.rq[S.rh];
+            S.rh = (S.rh + 1) % RQ_SZ; S.rn--;
+            S.task[i].st = TS_RUN;
+            return i;
+        }
+        if (!S.sn) throw "ERR: all threads blocked";
+        S32 w = (S32)(S.task[S.sq[0]].wake - (U32)millis());
+        if (w > 0) delay(w);
+    }
+}
+static void _schedule() {                  /// current thread queued or blocked, run next
+    int from = S.cur;
+    S.cur = _next();
+    if (S.cur != from) _switch(from, S.cur);
+}
+void task_yield() {
+    _timers();
+    if (!S.rn) return;                    /// nobody else ready, keep going
+    _ready(S.cur);
+    _schedule();
+}
+void task_sleep(U32 ms) {
+    Task &k = S.task[S.cur];
+    k.wake  = (U32)millis() + ms;
+    k.st    = TS_SLEEP;
+    int n   = S.sn++;                     /// insert, behind equal wake times
+    while (n && (S32)(S.task[S.sq[n - 1]].wake - k.wake) > 0) {
+        S.sq[n] = S.sq[n - 1]; n--;
+    }
+    S.sq[n] = S.cur;
+    _schedule();
+}
+///
+/// thread body, wakes up joiners and switches away for good
+///
+static void _body(Task &k) {
+    vm_use(k.vm);
+    try { k.t->dispatch(k.mx, 1); }
+    catch (const char *e) { LOG(e); LOG("\n"); }
+    gGC.detach(*k.t);
+    k.st  = TS_DONE;
+    int i = (int)(&k - S.task);
+    for (int j = 0; j <= TASK_SZ; j++) {
+        if (S.task[j].st == TS_BLOCK && S.task[j].join == i) _ready(j);
+    }
+    S.cur = _next();
+    _leave(S.cur);
+}
+static void _wait(Task &k, U32 id) {
+    Task &me = S.task[S.cur];
+    while (k.t && k.id == id && k.st != TS_DONE) {
+        me.join = (int)(&k - S.task);
+        me.st   = TS_BLOCK;
+        _schedule();
+    }
+    me.join = -1;
+}
+void task_block(Thread &t) {
+    Task &k = S.task[S.cur];
+    while (!k.woke) {
+        k.st = TS_BLOCK;
+        _schedule();
+    }
+    k.woke = false;
+}
+void task_wake(int i) {
+    Task &k = S.task[i];
+    k.woke = true;
+    if (k.st == TS_BLOCK && k.join < 0) _ready(i);
+}
+#else
+#if ARDUINO
+///
+/// device: FreeRTOS mutex, tasks delete themselves when done
+///
+void vm_acquire() {
+    if (!S.mx) S.mx = xSemaphoreCreateMutex();
+    if (xSemaphoreGetMutexHolder(S.mx) == xTaskGetCurrentTaskHandle()) return;
+    xSemaphoreTake(S.mx, portMAX_DELAY);
+}
+bool vm_release() {
+    if (!S.mx || xSemaphoreGetMutexHolder(S.mx) != xTaskGetCurrentTaskHandle()) return false;
+    xSemaphoreGive(S.mx);
+    return true;
+}
+void task_yield() {
+    if (!vm_release()) return;
+    taskYIELD();                  /// same priority tasks get their turn
+    vm_acquire();
+}
+static void _entry(void *p) { _body(*(Task*)p); vTaskDelete(NULL); }
+static void _os_start(Task &k) {
+    xTaskCreate(_entry, "jthread", TASK_STACK, &k, uxTaskPriorityGet(NULL), &k.h);
+}
+static void _os_done(Task &k) { k.st = TS_DONE; }
+static void _os_wait(Task &k, U32 id) {
+    while (k.t && k.id == id && k.st != TS_DONE) delay(1);
+}
+static void _os_reap(Task &k) { k.h = 0; }
+static void _os_block(Task &k) { while (!k.woke) delay(1); k.woke = false; }
+void task_wake(int i) { S.task[i].woke = true; }
+#else
+///
+/// host: fair ticket lock, waiters get the VM in arrival order
+///
+void vm_acquire() {
+    unique_lock<mutex> l(S.mx);
+    if (S.owner == this_thread::get_id()) return;
+    U32 tk = S.next++;
+    S.cv.wait(l, [tk]{ return S.serve == tk; });
+    S.owner = this_thread::get_id();
+}
+bool vm_release() {
+    {
+        lock_guard<mutex> l(S.mx);
+        if (S.owner != this_thread::get_id()) return false;
+        S.owner = thread::id();
+        S.serve++;
+    }
+    S.cv.notify_all();
+    return true;
+}
+void task_yield() {
+    {
+        lock_guard<mutex> l(S.mx);    /// nobody waiting, keep going
+        if (S.owner != this_thread::get_id() || S.next == S.serve + 1) return;
+    }
+    vm_release();
+    vm_acquire();
+}
+static void _os_start(Task &k) { k.os = thread(_body, ref(k)); }
+static void _os_done(Task &k) {
+    lock_guard<mutex> l(S.mx);
+    k.st = TS_DONE;
+}
+static void _os_wait(Task &k, U32 id) {
+    unique_lock<mutex> l(S.mx);
+    S.cv.wait(l, [&k, id]{ return !k.t || k.id != id || k.st == TS_DONE; });
+}
+static void _os_reap(Task &k) { if (k.os.joinable()) k.os.join(); }
+static void _os_block(Task &k) {
+    unique_lock<mutex> l(S.mx);
+    S.cv.wait(l, [&k]{ return k.woke; });
+    k.woke = false;
+}
+void task_wake(int i) {
+    {
+        lock_guard<mutex> l(S.mx);
+        S.task[i].woke = true;
+    }
+    S.cv.notify_all();
+}
+#endif // ARDUINO
+void task_sleep(U32 ms) {
+    bool held = vm_release();
+    delay(ms);
+    if (held) vm_acquire();
+}
+///
+/// thread body, runs ox.run() pushed by task_start under the VM lock
+///
+static void _body(Task &k) {
+    vm_use(k.vm);                         /// native thread of its own
+    vm_acquire();
+    try { k.t->dispatch(k.mx, 1); }
+    catch (const char *e) { LOG(e); LOG("\n"); }
+    gGC.detach(*k.t);
+    _os_done(k);
+    vm_release();
+}
+static void _wait(Task &k, U32 id) {
+    bool held = vm_release();             /// let the thread finish
+    _os_wait(k, id);
+    if (held) vm_acquire();
+}
+void task_block(Thread &t) {
+    bool held = vm_release();
+    _os_block(S.task[t.tid]);
+    if (held) vm_acquire();
+}
+#endif // GREEN_THREAD
+///
+/// free the slot of a finished thread (VM lock held)
+///
+static void _reap(Task &k) {
+    _os_reap(k);
+    delete k.t;
+    k.t  = 0;
+    k.id = 0;
+    k.st = TS_FREE;
+    k.woke = false;
+}
+///
+/// nm()V declared in class cx or its super classes
+///
+static IU _find(IU cx, const char *nm) {
+    IU pi = gPool.get_parm_idx("()V");
+    for (; cx != DATA_NA; cx = *(IU*)WORD(cx)->pfa(PFA_CLS_SUPR)) {
+        IU mx = gPool.find(nm, *(IU*)WORD(cx)->pfa(PFA_CLS_VT), pi);
+        if (mx != DATA_NA) return mx;
+    }
+    return DATA_NA;
+}
+void task_start(IU ox) {
+    vm_acquire();                             /// VM is shared from now on
+    if (THR_ID(ox)) throw "ERR: thread already started";
+    int i = 1;
+    for (; i <= TASK_SZ; i++) {
+        Task &k = S.task[i];
+        if (k.t && k.st == TS_DONE) _reap(k); /// finished but never joined
+        if (!k.t) break;
+    }
+    if (i > TASK_SZ) throw "ERR: too many threads";
+    IU   cx = OBJ_CX(ox);
+    Task &k = S.task[i];
+    k.t  = new Thread;
+    k.vm = gVM;
+    k.t->tid = i;
+    k.t->init(*(IU*)WORD(cx)->pfa(PFA_CLS_JDX));
+    k.t->push(ox);                            /// receiver of run(), pins ox
+    k.mx = _find(cx, "run");
+    k.id = THR_ID(ox) = ++S.serial;
+    k.st = TS_RUN;
+    _os_start(k);
+#if GREEN_THREAD
+    _ready(i);                                /// runs when the caller gives up the VM
+#endif // GREEN_THREAD
+}
+void task_join(IU ox) {
+    U32 id = THR_ID(ox);
+    for (int i = 1; id && i <= TASK_SZ; i++) {
+        Task &k = S.task[i];
+        if (!k.t || k.id != id) continue;
+        _wait(k, id);
+        if (k.t && k.id == id) _reap(k);      /// unless another joiner did
+        return;
+    }
+}
+void task_join_all() {
+    for (int i = 1; i <= TASK_SZ; i++) {
+        Task &k = S.task[i];
+        U32  id = k.id;
+        if (!k.t) continue;
+        _wait(k, id);
+        if (k.t && k.id == id) _reap(k);
+    }
+    vm_release();
+}
+///
+/// java/lang/Thread natives
+///
+static void _run(Thread &t) {                 /// default run(), calls target.run()
+    IU ox = t.pop();
+    DU r  = THR_TARGET(ox);
+    IU mx = r ? _find(OBJ_CX(r), "run") : DATA_NA;
+    if (mx == DATA_NA) return;
+    t.push(r);
+    t.dispatch(mx, 1);
+}
+static Method _thread[] = {
+    { "<init>", [](Thread &t){ t.pop(); },                                  ACL_PUBLIC, "()V" },
+    { "<init>", [](Thread &t){ DU r = t.pop(); THR_TARGET(t.pop()) = r; }, ACL_PUBLIC, "(Ljava/lang/Runnable;)V" },
+    { "start",  [](Thread &t){ task_start((IU)t.pop()); },                  ACL_PUBLIC, "()V" },
+    { "run",    _run,                                                       ACL_PUBLIC, "()V" },
+    { "join",   [](Thread &t){ task_join((IU)t.TOS); t.pop(); },           ACL_PUBLIC, "()V" },
+    { "sleep",  [](Thread &t){ task_sleep((U32)t.pop2()); },                ACL_PUBLIC, "(J)V" },
+    { "yield",  [](Thread &){ task_yield(); },                              ACL_PUBLIC, "()V" }
+};
+///
+/// java/lang/Thread in ROM, registered by java_setup
+///
+Ucode uThread(VTSZ(_thread), _thread);
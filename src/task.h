@@ -0,0 +1,35 @@
+///
+/// @brief nanoJVM threads behind java/lang/Thread
+/// Note:
+///   * each started Thread gets its own VM Thread, i.e. data and return stacks
+///   * GREEN_THREAD=1 (device default): all threads share one native thread,
+///     the scheduler keeps a ready queue and a sleep (timer) queue and
+///     switches when a time slice expires, on sleep/delay, on join and
+///     on a contended monitor
+///   * GREEN_THREAD=0: each thread runs on its own OS thread (host) or
+///     FreeRTOS task, gPool is shared, so a VM lock is held while running
+///     bytecode; it is handed over when a time slice expires and dropped
+///     around sleep and join, threads interleave but never race on gPool
+///   * the VM lock is taken by the first start(), a single thread never pays
+///   * thread table, queues and VM lock belong to the VM (gVM), threads of
+///     separate VMs never wait for each other
+///
+#ifndef NANOJVM_TASK_H
+#define NANOJVM_TASK_H
+#include "core.h"
+
+struct Sched;
+Sched *task_new();                /// thread table and scheduler of a new VM
+void   task_free(Sched *s);
+
+void vm_acquire();                /// take the VM lock (no-op when held or green)
+bool vm_release();                /// drop the VM lock, false if not held
+
+void task_yield();                /// let the next ready thread run
+void task_sleep(U32 ms);          /// other threads run meanwhile
+void task_start(IU ox);           /// run ox.run() on a new thread
+void task_join(IU ox);            /// wait until the thread of ox finished
+void task_join_all();             /// wait for every started thread
+void task_block(Thread &t);       /// park t until task_wake(t.tid)
+void task_wake(int tid);          /// resume a parked thread (or its next block)
+#endif // NANOJVM_TASK_H
@@ -2,9 +2,13 @@
 #include <iomanip>      // setbase
 #include <string>       // string class
 #include "ucode.h"
+#include "trace.h"
+#include "profile.h"
+#include "gc.h"
+#include "task.h"
+#include "monitor.h"
 
 extern Ucode uCode;
-extern void  ss_dump(Thread &t);
 ///==========================================================================
 /// Thread class implementation
 ///==========================================================================
@@ -22,9 +26,11 @@ extern void  ss_dump(Thread &t);
 IU get_nparm(U16 itype, char *parm) {
     char *p = parm+1;
     U16  nparm = itype==2 ? 0 : 1;  /// except static type, all have a object ref
-    while (*p != ')') {             /// count number of parameters
-        if (*p++=='L') while (*p++ != ';');          /// (Ljava/lang/String;)
-        nparm++;
+    while (*p != ')') {             /// count parameter slots, long/double take two
+        char c = *p;
+        while (*p==TYPE_ARRAY) p++;                  /// ([I) array is a reference
+        if (*p++==TYPE_OBJ) while (*p++ != TYPE_OBJ_END);  /// (Ljava/lang/String;)
+        nparm += TYPE_WIDE(c) ? 2 : 1;
     }
     return nparm;
 }
@@ -38,16 +44,19 @@ KV Thread::get_refs(IU j, IU itype) {
 	IU rf  = jOff(mj);              				 /// [13]008f:c=>[15,16]  [method_name, parm_name]
 
 	char cls[128], nm[128], parm[32];
-	LOG(" "); LOG(jStrRef(cj, cls));        		 /// get class name
-	LOG("."); LOG(jStr(jU16(rf + 1), nm));  		 /// get method name
-	LOG(":"); LOG(jStr(jU16(rf + 3), parm));		 /// get param list name
+	jStrRef(cj, cls);                                /// get class name
+	jStr(jU16(rf + 1), nm);                          /// get method name
+	jStr(jU16(rf + 3), parm);                        /// get param list name
+	DLOG(" "); DLOG(cls); DLOG("."); DLOG(nm); DLOG(":"); DLOG(parm);
 
     struct KV r;
     r.key = j;                                               /// java class file index
 	r.ctx = gPool.get_class(cls);                            /// context (class/vocabulary) ref
 	if (itype!=DATA_NA) {
 		IU pi   = gPool.get_parm_idx(parm);                  /// parameter list
-		r.ref   = gPool.get_method(nm, r.ctx, pi, itype!=1); /// special does not go up to super class
+		r.ref   = r.ctx == DATA_NA                           /// class not loaded, by name only
+		    ? gPool.get_method(nm, r.ctx, pi)
+		    : gPool.resolve_method(nm, r.ctx, pi);           /// class named by the ref, then up its supers
 		r.nparm = get_nparm(itype, parm);
 	}
 	return r;
@@ -56,29 +65,60 @@ KV Thread::get_refs(IU j, IU itype) {
 /// VM Execution Unit
 ///
 void Thread::na() { LOG(" **NA**"); }/// feature not supported yet
+void Thread::preempt() {
+    budget = gVM->quantum;           /// refill time slice
+    task_yield();                    /// other Java threads take their turn
+    yield();                         /// gives some cycles to main thread (ESP32 watchdog)
+}
 void Thread::init(int jcf) {
 	M0  = &gPool.pmem[0];            /// cache memory-base pointer
 	J   = Loader::get(jcf);          /// cache Java class file pointer
 	ctx = J->ctx;                    /// reset context (class/vocabulary)
+	gGC.attach(*this);               /// data and return stacks are gc roots
 }
 void Thread::dispatch(IU mx, U16 nparm) {
+    TRACE(TRACE_CALL, TR_CALL, 0, IP, mx, *this);
+    PROFILE(call, mx, execute(mx, nparm));
+}
+void Thread::execute(IU mx, U16 nparm) {
     Word *w = WORD(mx);              /// method store in dictionary (pmem)
     if (w->java) {                   /// is a Java function?
         IU  addr = *(IU*)w->pfa();   /// * fetch Java function storage
-        java_call(addr, nparm);      /// * call Java inner interpreter
+        ClassFile *cf = Loader::get(*(IU*)w->pfa(PFA_JAVA_JDX));
+        U32 *lw  = 0;                /// * monitor of synchronized method
+        if (w->ftype & (SYNC_FLAG >> 2)) {
+            if (w->ftype & (STATIC_FLAG >> 2)) lw = (U32*)WORD(cf->ctx)->pfa(PFA_CLS_LOCK);
+            else {
+                IU ox = (IU)peek(nparm - 1);
+                rs.push(ox);         ///   pinned until the call returns
+                lw = &OBJ(ox)->lock;
+            }
+            gMon.enter(*this, lw);
+        }
+        if (cf == J) java_call(addr, nparm); /// * call Java inner interpreter
+        else {                       /// * bytecode in another class file
+            ClassFile *J0 = J;       ///   switch class file and context
+            IU c0 = ctx;
+            J = cf; ctx = cf->ctx;
+            java_call(addr, nparm);
+            J = J0; ctx = c0;
+        }
+        if (lw) {
+            gMon.leave(*this, lw);
+            if (!(w->ftype & (STATIC_FLAG >> 2))) rs.pop();
+        }
     }
     else if (w->forth) {             /// is a user defined Forth word?
-        gPool.rs.push(IP);           /// * setup call frame
+        rs.push(IP);           /// * setup call frame
         IP = (IU)(w->pfa() - M0);    /// * get new IP
         while (IP) {                 /// Forth inner interpreter
             mx = *(IU*)(M0 + IP);    /// * fetch next instruction
-            LOG("\nm"); LOX4(IP-1); LOG(":"); LOX4(mx);
-            LOG(" "); LOG(WORD(mx)->nfa());
+            TRACE(TRACE_INST, TR_WORD, 0, IP, mx, *this);
             IP += sizeof(IU);        /// * increment IP (too bad, we cannot do IP++)
-            yield();                 /// * gives some cycles to main thread (ESP32)
+            tick();                  /// * gives some cycles to main thread when quantum expires
             dispatch(mx);            /// * recursively call Forth inner interpreter
         }
-        IP = gPool.rs.pop();         /// * restore call frame
+        IP = rs.pop();         /// * restore call frame
     }
     else {                           /// must be a native method
         fop xt = *(fop*)w->pfa();    /// * get native method pointer
@@ -91,88 +131,246 @@ void Thread::dispatch(IU mx, U16 nparm) {
 void Thread::java_new()  {
 	IU j = fetch2();                /// class index
 	char cls[128];
-	LOG(" "); LOG(jStrRef(j, cls));
+	jStrRef(j, cls);
+	DLOG(" "); DLOG(cls);
 	IU cx = gPool.get_class(cls);
-    IU ox = gPool.add_obj(cx);
+    IU ox = gPool.add_obj(cx, &tlab);
     push(ox);                       /// save object onto stack
 }
-void Thread::java_call(IU j, U16 nparm) {   /// Java inner interpreter
-    gPool.rs.push(SP);              /// keep caller stack frame
+///
+/// Java method call frame, shared by both engines
+///
+void Thread::frame_in(IU j, U16 nparm) {
+    rs.push(SP);              /// keep caller stack frame
     SP = ss.idx - nparm + 1;        /// adjust local variable base, extra 1=obj ref, TODO: handle types
     U16 n = ss.idx + jU16(j - 6) - nparm;   /// allocate for local variables
     while (ss.idx < n) push(0);     /// setup local variables, TODO: change ss.idx only
-
-    U8 op;                          /// opcode
-    gPool.rs.push(IP);              /// save caller instruction pointer
+    rs.push(IP);              /// save caller instruction pointer
+    fr.push({ J, j, SP });          /// locals typed by gc
     IP = j;                         /// pointer to class file
+}
+void Thread::frame_out(U8 op) {
+    fr.pop();
+    IP = rs.pop();            /// restore to caller IP
+    // restore caller stack frame
+    int n = op == OP_RETURN ? 0 : (op == OP_LRETURN || op == OP_DRETURN) ? 2 : 1;
+    DU  rv[2];                      /// return value, long/double in two cells
+    for (int i = 0; i < n; i++) rv[i] = pop();
+    while (ss.idx >= SP) pop();     /// clean off stack (optional)
+    SP = rs.pop();        	/// restore SP
+    while (n) push(rv[--n]);        /// add return value if any
+}
+void Thread::java_call(IU j, U16 nparm) {   /// Java inner interpreter
+#if CGOTO_ENGINE
+    if (cgoto && J->image() && !TRACE_ON(TRACE_INST) && !PROF_ON) {
+        java_fast(j, nparm);        /// direct-threaded engine does not trace or profile opcodes
+        return;
+    }
+#endif // CGOTO_ENGINE
+    U8 op = 0;                      /// opcode
+    frame_in(j, nparm);
     while (IP) {
-        yield();                    /// gives main thread some cycles (ESP32)
-        ss_dump(*this);
+        tick();                     /// gives main thread some cycles when quantum expires
         op = fetch();               /// fetch JVM opcode
-        LOG("j"); LOX4(IP-1); LOG(":"); LOX2(op);
-        LOG(" "); LOG(uCode.vt[op].name);
-        uCode.exec(*this, op);      /// execute JVM opcode (in microcode ROM)
+        TRACE(TRACE_INST, TR_JOP, op, IP-1, 0, *this);
+        PROFILE(op, op, uCode.exec(*this, op)); /// execute JVM opcode (in microcode ROM)
     }
-    IP = gPool.rs.pop();            /// restore to caller IP
-    // restore caller stack frame
-    DU rv = op == OP_RETURN ? 0 : pop(); /// check return value
-    while (ss.idx >= SP) pop();     /// clean off stack (optional)
-    SP = gPool.rs.pop();        	/// restore SP
-    if (op==OP_RETURN) push(rv);    /// add return value if any
+    frame_out(op);
 }
 void Thread::invoke(U16 itype) {    /// invoke type: 0:virtual, 1:special, 2:static, 3:interface, 4:dynamic
-    IU j = fetch2();                /// 2 - method index in pool
+    IU op = IP - 1;                 /// opcode address (for quickening)
+    IU j  = fetch2();               /// 2 - method index in pool
     if (itype>2) IP += 2;           /// extra 2 for interface and dynamic
     IU mi = gPool.lookup(gPool.vt, j, ctx);  /// search cache first
-    if (mi != DATA_NA) {
-        Word *w = WORD(gPool.vt[mi].ref);
-        LOG(" "); LOG(w->nfa());
-        dispatch(gPool.vt[mi].ref, gPool.vt[mi].nparm);
+    if (mi == DATA_NA) {
+        ///
+        /// cache missed, create new lookup entry
+        ///
+        KV r = get_refs(j, itype);  /// { key=j, ctx, ref=mx, nparm }
+        r.ctx = ctx;                /// keyed by calling context, j is local to its class file
+        DLOG(" =>$"); DLOX(gPool.vt.idx);
+        mi = gPool.vt.push(r);
+    }
+    KV &m = gPool.vt[mi];
+    if (m.ref == DATA_NA) { na(); return; }
+    DLOG(" "); DLOG(WORD(m.ref)->nfa());
+    if (itype==0) {                 /// virtual, dispatch on receiver class
+        IU ci = gPool.lookup(gPool.ic, op, ctx);
+        if (ci == DATA_NA && gPool.ic.idx < IC_LU_SZ) {
+            ci = gPool.ic.push({ op, ctx, mi, 0, {}, {} });
+        }
+        if (ci != DATA_NA) { quicken(op, OP_INVOKEV_Q, ci); invoke_v(ci); }
+        else {                      /// out of call site caches, index vtable
+            IU ox = (IU)peek(m.nparm - 1);
+            dispatch(ox ? gPool.get_virtual(OBJ_CX(ox), m.ref) : m.ref, m.nparm);
+        }
         return;
     }
-    ///
-    /// cache missed, create new lookup entry
-    ///
-    KV r = get_refs(j, itype);     /// { key=j, ctx, ref=mx, nparm }
-
-	LOG(" =>$"); LOX(gPool.vt.idx);
-    gPool.vt.push(r);
-
-    if (r.ref != DATA_NA) dispatch(r.ref, r.nparm);
-    else                  na();
+    quicken(op, itype>2 ? OP_INVOKEI_Q : OP_INVOKE_Q, mi);
+    dispatch(m.ref, m.nparm);
+}
+///
+/// invokevirtual through call site inline cache
+///   receiver class is read from the object header, a null receiver
+///   (i.e. System.out, which has no instance) takes the static resolution
+///
+void Thread::invoke_v(IU ci) {
+    IC &c  = gPool.ic[ci];
+    KV &m  = gPool.vt[c.vi];
+    IU ox  = (IU)peek(m.nparm - 1); /// receiver, below the parameters
+    IU mx  = m.ref;
+    if (ox) {
+        IU  cx = OBJ_CX(ox);
+        int n  = c.n < IC_WAYS ? c.n : IC_WAYS, i = 0;
+        while (i < n && c.cx[i] != cx) i++;
+        if (i < n) mx = c.mx[i];    /// cache hit
+        else {                      /// miss, index vtable and fill a way
+            mx = gPool.get_virtual(cx, m.ref);
+            if (c.n < IC_WAYS) { c.cx[c.n] = cx; c.mx[c.n] = mx; }
+            if (c.n <= IC_WAYS) c.n++;  /// IC_WAYS+1: megamorphic
+        }
+    }
+    dispatch(mx, m.nparm);
+}
+///
+/// rewrite a resolved call/field site into its quick form
+/// Note: wide operands are left alone, they are not quickened, nor are
+///       operands past 16 bits (e.g. a pmem address with 32-bit IU)
+///
+void Thread::quicken(IU addr, U8 op, IU v) {
+#if BC_QUICKEN
+    if (wide || v > 0xffff || !J->patch(addr, op, (U16)v)) return;
+    DLOG(" =>q"); DLOX(op);
+#endif // BC_QUICKEN
+}
+///
+/// int and float constants are pushed by value, others (i.e. strings) by pool index
+///
+DU Thread::ldc(U16 j) {
+    IU a   = jOff(j);
+    U8 tag = J->getU8(a);
+    return (tag==CONST_INT || tag==CONST_FLOAT) ? (DU)J->getU32(a + 1) : (DU)j;
 }
 ///
 /// class and instance variable access
-///   Note: use gPool.vref is a bit wasteful but avoid the runtime search. TODO:
+///   Note: field refs resolve once into the declared layout (see ClassFile::create_field),
+///         gPool.cv/iv cache them for sites that cannot be quickened
 ///
-DU *Thread::cls_var() {
-	U16 j = J16;
-    IU  i = gPool.lookup(gPool.cv, j, ctx);
-    if (i != DATA_NA) { return (DU*)&gPool.pmem[gPool.cv[i].ref]; }
+IU Thread::field_ref(IU j, IU &cx) {
+	IU c_f = jOff(j);                   /// [09]:[class_idx, name_type_idx]
+	IU nt  = jOff(jU16(c_f + 3));       /// [0c]:[field_name, type_name]
+	char cls[128], nm[128];
+	jStrRef(jU16(c_f + 1), cls);        /// class named by the field ref
+	jStr(jU16(nt + 1), nm);             /// field name
+	DLOG(" "); DLOG(cls); DLOG("."); DLOG(nm);
+
+	IU c0 = cx = gPool.get_class(cls);
+	IU fx = gPool.get_field(nm, cx);    /// cx becomes the declaring class
+	if (fx == DATA_NA) cx = c0;         /// builtin class, storage only
+	return fx;
+}
+DU *Thread::cls_var(U8 &t) {
+    IU  op = IP - 1;                    /// opcode address (for quickening)
+    U8  q  = J->getU8(op)==0xb2 ? OP_GETSTATIC_Q : OP_PUTSTATIC_Q;
+	U16 j  = J16;
+    IU  i  = gPool.lookup(gPool.cv, j, ctx);
+    if (i != DATA_NA) {
+        t = (U8)gPool.cv[i].nparm;
+        if (!TYPE_WIDE(t)) quicken(op, q, gPool.cv[i].ref);
+        return (DU*)&gPool.pmem[gPool.cv[i].ref];
+    }
 
     /// cache missed, create new lookup entry
-    IU   idx = gPool.cv.idx;
-    KV   r   = get_refs(j);             /// fetch java class file references
-    Word *w  = WORD(r.ctx);             /// remap to storage
-    DU   *cv = (DU*)w->pfa(PFA_CLS_CV) + idx;
-    IU   ref = (IU)((U8*)cv - M0);
+    IU   cx, fx = field_ref(j, cx);
+    IU   off  = fx==DATA_NA ? 0 : *(IU*)WORD(fx)->pfa(PFA_FLD_OFF);
+    DU   *cv  = (DU*)(WORD(cx)->pfa(PFA_CLS_CV) + off);
+    IU   ref  = (IU)((U8*)cv - M0);
+    t = fx==DATA_NA ? TYPE_INT : *WORD(fx)->pfa(PFA_FLD_TYPE);
 
-    LOG(" =>$"); LOX(idx);
-    gPool.cv.push({ j, ctx, ref, 0 });  /// create new cache entry
+    DLOG(" =>$"); DLOX(ref);
+    gPool.cv.push({ j, ctx, ref, t });  /// create new cache entry, nparm keeps the type
+    if (!TYPE_WIDE(t)) quicken(op, q, ref);  /// long/double stay on the slow path
     return cv;
 }
-DU *Thread::inst_var(IU ox) {
+void Thread::getstatic() {
+    U8 t;
+    DU *p = cls_var(t);
+    if (TYPE_WIDE(t)) push2(*(S64*)p);
+    else push(*p);
+}
+void Thread::putstatic() {
+    U8 t;
+    DU *p = cls_var(t);
+    if (TYPE_WIDE(t)) *(S64*)p = pop2();
+    else *p = pop();
+}
+///
+/// instance fields, narrow types are packed (see ClassFile::create_field)
+///   resolved site is quickened into the typed quick opcode
+///
+U8 Thread::inst_var(bool get, IU &off) {
+    IU  op  = IP - 1;                   /// opcode address (for quickening)
 	U16 j   = J16;
-    DU  *iv = (DU*)OBJ(ox)->pfa();
     IU  i   = gPool.lookup(gPool.iv, j, ctx);
-    if (i != DATA_NA) return iv + gPool.iv[i].ref;
-
-    // cache missed, create new lookup entry
-    KV r   = get_refs(j);              /// for debug display only
-    IU ref = gPool.iv.idx;
-    LOG(" =>$"); LOX(ref);
-    gPool.iv.push({ j, ctx, ref, 0 }); /// create new cache entry
-    return iv + ref;
+    IU  fx;
+    if (i != DATA_NA) fx = gPool.iv[i].ref;
+    else {                              /// cache missed, create new lookup entry
+        IU cx;
+        fx = field_ref(j, cx);
+        if (fx == DATA_NA) { na(); return 0; }
+        DLOG(" =>$"); DLOX(fx);
+        gPool.iv.push({ j, ctx, fx, 0 });
+    }
+    Word *f = WORD(fx);
+    U8   t  = *f->pfa(PFA_FLD_TYPE);
+    off = *(IU*)f->pfa(PFA_FLD_OFF);
+    switch (t) {
+    case TYPE_BYTE: case TYPE_BOOL:
+        quicken(op, get ? OP_GETFIELD_B : OP_PUTFIELD_B, off); break;
+    case TYPE_CHAR:
+        quicken(op, get ? OP_GETFIELD_C : OP_PUTFIELD_S, off); break;
+    case TYPE_SHORT:
+        quicken(op, get ? OP_GETFIELD_S : OP_PUTFIELD_S, off); break;
+    case TYPE_LONG: case TYPE_DOUBLE:   /// two cells, not quickened
+        break;
+    default:
+        quicken(op, get ? OP_GETFIELD_Q : OP_PUTFIELD_Q, off); break;
+    }
+    return t;
+}
+void Thread::getfield() {
+    IU off;
+    U8 t  = inst_var(true, off);
+    U8 *p = OBJ((IU)pop())->data + off;
+    switch (t) {
+    case 0:         push(0);         break;  /// unresolved
+    case TYPE_BYTE:
+    case TYPE_BOOL: push(*(S8*)p);   break;
+    case TYPE_CHAR: push(*(U16*)p);  break;
+    case TYPE_SHORT:push(*(S16*)p);  break;
+    case TYPE_LONG:
+    case TYPE_DOUBLE:push2(*(S64*)p); break;
+    default:        push(*(DU*)p);   break;
+    }
+}
+void Thread::putfield() {
+    IU off;
+    U8 t  = inst_var(false, off);
+    if (TYPE_WIDE(t)) {                      /// two cells, value above the ref
+        S64 v = pop2();
+        *(S64*)(OBJ((IU)pop())->data + off) = v;
+        return;
+    }
+    DU v  = pop();
+    U8 *p = OBJ((IU)pop())->data + off;
+    switch (t) {
+    case 0:                                  break;  /// unresolved
+    case TYPE_BYTE:
+    case TYPE_BOOL: *(S8*)p  = (S8)v;        break;
+    case TYPE_CHAR:
+    case TYPE_SHORT:*(S16*)p = (S16)v;       break;
+    default:        *(DU*)p  = v;            break;
+    }
 }
 ///
 /// array support
@@ -180,32 +378,16 @@ DU *Thread::inst_var(IU ox) {
 ///
 void Thread::java_newa(IU n) {      /// create 1-d array
 	U8 j  = fetch();                /// fetch atype value
-    if (j != 0xa) na();             /// support only integer, TODO: more types
-    else {
-        IU ax = gPool.add_array(j, n);
-        push(ax);
-    }
+    if (j < T_BOOLEAN || j > T_LONG) { na(); return; }
+    IU ax = gPool.add_array(j, n, &tlab);
+    push(ax);
 }
 ///
 /// create array of references (i.e. 2-dim array)
 /// Note: using DU for ref (IU) is a bit wasteful, but uniform
 ///
 void Thread::java_anewa(IU n) {
-	U16 j   = fetch2();             /// fetch 2-dim atype, ignore now, TODO: check type
-    IU  c_f = jOff(j);              /// [02]000f =>[I
-    IU  t2  = jU16(c_f);
-    IU  ax  = gPool.add_array(t2 >> 8, n);   /// allocate array
+	fetch2();                       /// class of elements, not checked
+    IU  ax  = gPool.add_array(T_REF, n, &tlab); /// allocate array
     push(ax);
 }
-IU   Thread::alen(IU ax) {                   /// array length
-    IU *p = (IU*)OBJ(ax);
-    return *(p + 1);
-}
-void Thread::astore(IU ax, IU idx, DU v) {   /// array store
-    DU *a0 = (DU*)OBJ(ax)->data;
-    *(a0 + idx) = v;
-}
-DU *Thread::aload(IU ax, IU idx) {           /// array fetch (load onto stack)
-    DU *a0 = (DU*)OBJ(ax)->data;
-    return a0 + idx;
-}
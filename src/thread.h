@@ -2,6 +2,32 @@
 #define NANOJVM_THREAD_H
 #include "core.h"           /// List
 #include "loader.h"         /// loader and common types
+#include "mmu.h"            /// OBJ
+#include "vm.h"             /// gPool of the current VM
+///
+/// float in one cell, double in two (as long), bit patterns kept as is
+///
+inline DU  fbits(F32 v) { DU  c = 0; memcpy(&c, &v, sizeof(v)); return c; }
+inline F32 bitsf(DU c)  { F32 v;     memcpy(&v, &c, sizeof(v)); return v; }
+inline S64 dbits(F64 v) { S64 c;     memcpy(&c, &v, sizeof(v)); return c; }
+inline F64 bitsd(S64 c) { F64 v;     memcpy(&v, &c, sizeof(v)); return v; }
+///
+/// Java f2i/d2i, f2l/d2l: NaN is 0, out of range saturates
+///
+inline S32 f2i(F64 v) {
+    return v != v ? 0 : v >= 2147483647.0 ? INT32_MAX : v <= -2147483648.0 ? INT32_MIN : (S32)v;
+}
+inline S64 f2l(F64 v) {
+    return v != v ? 0 : v >= 9223372036854775807.0 ? INT64_MAX : v <= -9223372036854775808.0 ? INT64_MIN : (S64)v;
+}
+///
+/// Java call frame, kept for gc to type the locals by bytecode
+///
+struct Frame {
+    ClassFile *J;           /// class file of the method
+    IU    j;                /// code address in class file
+    U16   sp;               /// local variable base in ss
+};
 ///
 /// Thread class
 ///
@@ -16,10 +42,17 @@ struct Thread {
     DU    base    = 10;     /// radix
     bool  compile = false;  /// compile flag
     bool  wide    = false;  /// wide flag
+    bool  cgoto   = true;   /// use direct-threaded engine (if built with CGOTO_ENGINE)
+    S32   budget  = VM_QUANTUM; /// opcodes left in current time slice
+    U32   icnt    = 0;      /// opcodes charged so far (for benchmarking)
+    U16   tid     = 0;      /// thread table slot (monitor owner), 0: main
     ///
     /// local storage
     ///
     List<DU, SS_SZ>  ss;    /// data stack
+    List<DU, RS_SZ>  rs;    /// return stack (call frames)
+    List<Frame, RS_SZ/2> fr;/// Java call frames, two rs cells each
+    Tlab  tlab;             /// thread-local allocation buffer
     ClassFile *J;           /// Java class file pointer
     U8 *M0;                 /// cached base address of memory pool
     ///
@@ -27,51 +60,90 @@ struct Thread {
     ///
     struct KV get_refs(IU j, IU itype=DATA_NA);
     void na();                           /// not supported
+    void preempt();                      /// time slice expired, yield and refill
+    void tick(S32 n=1) { icnt += n; if ((budget -= n) <= 0) preempt(); }
     void init(int jcf);                  /// initialize
     void dispatch(IU mx, U16 nparm=0);   /// instruction dispatcher
+    void execute(IU mx, U16 nparm=0);    /// run a word (Java, Forth or native)
     ///
     /// Java core opcodes
     ///
     void java_new();                     /// instantiate Java object
-    void java_call(IU j, U16 nparm=0);   /// execute Java method
+    void java_call(IU j, U16 nparm=0);   /// execute Java method (reference engine)
+    void java_fast(IU j, U16 nparm=0);   /// execute Java method (direct-threaded engine)
+    void frame_in(IU j, U16 nparm);      /// setup Java call frame
+    void frame_out(U8 op);               /// restore caller frame, keep return value
     void invoke(U16 itype);              /// invoke type: 0:virtual, 1:special, 2:static, 3:interface, 4:dynamic
+    void invoke_v(IU ci);                /// invokevirtual through inline cache gPool.ic[ci]
+    void quicken(IU addr, U8 op, IU v);  /// rewrite resolved bytecode into quick opcode
+    DU   ldc(U16 j);                     /// constant pool entry j as pushed by ldc/ldc_w
     ///
     /// class and instance variable access
     ///
-    DU   *cls_var();
-    DU   *inst_var(IU ox);
+    IU   field_ref(IU j, IU &cx);        /// resolve field ref, cx: declaring class
+    DU   *cls_var(U8 &t);                /// resolve class field ref, t: type
+    U8   inst_var(bool get, IU &off);    /// resolve instance field ref, returns type
+    void getstatic();
+    void putstatic();
+    void getfield();
+    void putfield();
+    ///
+    /// quick opcodes, operand carries resolved index (no lookup)
+    ///
+    void invoke_q(U16 xtra) {
+        IU i = fetch2();  IP += xtra;
+        dispatch(gPool.vt[i].ref, gPool.vt[i].nparm);
+    }
+    DU   *cls_var_q()       { return (DU*)&gPool.pmem[fetch2()]; }
+    U8   *inst_var_q(IU ox) { return OBJ(ox)->data + fetch2(); }
     ///
-    /// Java array opcodes
+    /// Java array opcodes, elements stored at their natural width T
     ///
     void java_newa(IU n);                /// instantiate Java array
     void java_anewa(IU n);               /// create multi-dimension array
-    IU   alen(IU ax);                    /// return array length
-    void astore(IU ax, IU idx, DU v);    /// store v into array[idx]
-    DU   *aload(IU ax, IU idx);          /// fetch v from array[idx]
+    IU   alen(IU ax)    { return OBJ(ax)->n; }
+#if RANGE_CHECK
+    IU   aidx(IU ax, IU idx) {
+        if (idx >= OBJ(ax)->n) throw "ERR: array index out of bounds";
+        return idx;
+    }
+#else
+    IU   aidx(IU ax, IU idx) { return idx; }
+#endif // RANGE_CHECK
+    template<typename T>
+    T    aget(IU ax, IU idx)      { return *((T*)OBJ(ax)->data + aidx(ax, idx)); }
+    template<typename T>
+    void aput(IU ax, IU idx, T v) { *((T*)OBJ(ax)->data + aidx(ax, idx)) = v; }
     ///
     /// Java class file byte fetcher
     ///
     U8   fetch()        { return J->getU8(IP++); }
-    U16  fetch2()       { U16 n = J->getU16(IP);  IP+=2; LOG(" #"); LOX(n); return n; }
-    U16  fetch4()       { U32 n = J->getU32(IP);  IP+=4; LOG(" #"); LOX(n); return n; }
+    U16  fetch2()       { U16 n = J->getU16(IP);  IP+=2; return n; }
+    U16  fetch4()       { U32 n = J->getU32(IP);  IP+=4; return n; }
     ///
     /// branching ops
     ///
     void ret()          { IP = 0; }		  /// exit java_call/forth_word loop
-    void jmp()          { IP += J->getU16(IP) - 1; }
-    void cjmp(bool f)   { IP += f ? J->getU16(IP) - 1 : sizeof(U16); }
+    void jmp()          { IP += (S16)J->getU16(IP) - 1; }   /// signed branch offset
+    void cjmp(bool f)   { IP += f ? (S16)J->getU16(IP) - 1 : sizeof(U16); }
     ///
     /// stack ops
     ///
     void push(DU v)     { ss.push(TOS); TOS = v; }
     DU   pop()          { DU n = TOS; TOS = ss.pop(); return n; }
+    DU   peek(U16 d)    { return d ? ss[-d] : TOS; }  /// d-th item below TOS
+    ///
+    /// long/double take two cells, low cell first, i.e. high cell on top
+    ///
+    void push2(S64 v)   { push((DU)v); push((DU)(v >> 32)); }
+    S64  pop2()         { U64 hi = (U32)pop(); return (S64)((hi << 32) | (U32)pop()); }
     ///
     /// local variable access
     ///
 #if RANGE_CHECK
     void iinc() {
     	U8 i = fetch();
-    	U8 v = fetch();
+    	S8 v = (S8)fetch();
         if ((SP+i) > ss.idx) throw "ERR: iinc > ss.idx";
         ((SP+i)==ss.idx) ? TOS += v : ss[SP + i] += v;
     }
@@ -92,5 +164,7 @@ struct Thread {
     template<typename T>
     void store(U16 i, T n) { ((SP+i)==ss.idx) ? TOS = n : *(T*)&ss[SP + i] = n; }
 #endif // RANGE_CHECK
+    S64  load2(U16 i)   { return (S64)(((U64)(U32)load(i + 1, (S32)0) << 32) | (U32)load(i, (S32)0)); }
+    void store2(U16 i, S64 v) { store(i, (S32)v); store(i + 1, (S32)(v >> 32)); }
 };
 #endif // NANOJVM_THREAD_H
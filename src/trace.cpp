@@ -0,0 +1,43 @@
+#include "trace.h"
+#include "ucode.h"
+
+extern Ucode uCode;
+///
+/// append a record, oldest one is overwritten when the ring is full
+///
+void Tracer::add(U8 type, U8 op, IU ip, IU mx, Thread &t) {
+    TraceRec &x = r[n++ % TRACE_SZ];
+    x.type  = type;
+    x.op    = op;
+    x.ip    = ip;
+    x.mx    = mx;
+    x.depth = (U16)t.ss.idx;
+    x.tos   = level >= TRACE_STACK ? t.TOS : 0;
+}
+///
+/// decode ring buffer
+///
+void Tracer::dump() {
+    U32 i0 = n > TRACE_SZ ? n - TRACE_SZ : 0;
+    LOG("\ntrace: "); LOX(n - i0); LOG("/"); LOX(n); LOG(" records");
+    for (U32 i = i0; i < n; i++) {
+        TraceRec &x = r[i % TRACE_SZ];
+        switch (x.type) {
+        case TR_CALL:
+            LOG("\n  call "); LOX4(x.mx); LOG(" "); LOG(WORD(x.mx)->nfa());
+            break;
+        case TR_WORD:
+            LOG("\n  m"); LOX4(x.ip); LOG(":"); LOX4(x.mx);
+            LOG(" "); LOG(WORD(x.mx)->nfa());
+            break;
+        case TR_JOP:
+            LOG("\n  j"); LOX4(x.ip); LOG(":"); LOX2(x.op);
+            LOG(" "); LOG(uCode.vt[x.op].name);
+            break;
+        }
+        LOG(" <"); LOX(x.depth); LOG(">");
+        if (level >= TRACE_STACK) { LOG(" "); LOX(x.tos); }
+        yield();
+    }
+    LOG("\n");
+}
@@ -0,0 +1,47 @@
+///
+/// @brief nanoJVM execution tracer
+/// Note:
+///   * records go into a binary ring buffer, decoded later by dump()
+///   * compiled out with ENABLE_TRACE=0, one branch per hook when level is off
+///
+#ifndef NANOJVM_TRACE_H
+#define NANOJVM_TRACE_H
+#include "core.h"
+///
+/// trace levels (runtime selectable)
+///
+enum { TRACE_OFF = 0, TRACE_CALL, TRACE_INST, TRACE_STACK };
+///
+/// trace record types
+///
+enum { TR_CALL = 0, TR_WORD, TR_JOP };
+struct TraceRec {             /// 12-byte record, 20 with 32-bit IU
+    U8  type;                 /// TR_CALL, TR_WORD, TR_JOP
+    U8  op;                   /// JVM opcode
+    IU  ip;                   /// instruction pointer
+    IU  mx;                   /// method/word index in pmem
+    U16 depth;                /// data stack depth
+    DU  tos;                  /// top of stack (TRACE_STACK only)
+};
+struct Tracer {
+    U8       level = TRACE_OFF;    /// current trace level
+    U32      n     = 0;            /// total records written
+    TraceRec *r;                   /// ring buffer
+
+    Tracer()  { r = new TraceRec[TRACE_SZ]; }
+    ~Tracer() { delete[] r; }
+
+    void add(U8 type, U8 op, IU ip, IU mx, Thread &t);
+    void clear() { n = 0; }
+    void dump();                   /// decode ring buffer, oldest first
+};
+
+#if ENABLE_TRACE
+#define TRACE(lvl, type, op, ip, mx, t) \
+    if (gTrace.level >= (lvl)) gTrace.add(type, op, ip, mx, t)
+#define TRACE_ON(lvl)   (gTrace.level >= (lvl))
+#else
+#define TRACE(lvl, type, op, ip, mx, t)
+#define TRACE_ON(lvl)   false
+#endif // ENABLE_TRACE
+#endif // NANOJVM_TRACE_H
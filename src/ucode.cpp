@@ -1,66 +1,71 @@
+#include <math.h>       // fmodf, fmod
 #include "ucode.h"
+#include "monitor.h"
 ///
 /// macros for reduce verbosity
 ///
 #define TopS32        (*(S32*)&t.TOS)
-#define TopS64        (*(S64*)&t.TOS)
 #define TopF32        (*(F32*)&t.TOS)
-#define TopF64        (*(F64*)&t.TOS)
 #define TopU32        (*(U32*)&t.TOS)
-#define TopU64        (*(U64*)&t.TOS)
-#define PushI(n)      (t.push((S32)n))        /** TOS updated */
-#define PushL(n)      (t.push((S64)n))        /** TOS updated */
-#define PushF(n)      (t.na())
-#define PushD(n)      (t.na())
-#define PushA(n)      (t.push((P32)n))
+#define PushI(n)      (t.push((S32)(n)))      /** TOS updated */
+#define PushL(n)      (t.push2((S64)(n)))     /** two cells, high on top */
+#define PushF(n)      (t.push(fbits((F32)(n))))   /** one cell */
+#define PushD(n)      (t.push2(dbits((F64)(n)))) /** two cells, as long */
+#define PushA(n)      (t.push((P32)(n)))
 #define PopI()        ((S32)t.pop())          /** TOS updated */
-#define PopL()        ((S64)t.pop())          /** TOS updated */
-#define PopF()        (t.na())
-#define PopD()        (t.na())
+#define PopL()        (t.pop2())              /** two cells, high on top */
+#define PopF()        (bitsf(t.pop()))
+#define PopD()        (bitsd(t.pop2()))
 #define PopA()        ((P32)t.pop())
 #define PopR()        ((P32)t.pop())
 #define PopI2T()      ((S32)t.pop())
-#define PopL2T()      ((S64)t.pop())
-#define PopF2T()      (t.na())
-#define PopD2T()      (t.na())
+#define PopF2T()      (bitsf(t.pop()))
+#define PopD2T()      (bitsd(t.pop2()))
 #define PopA2T()      ((P32)t.pop())
 #define PopR2T()      ((P32)t.pop())
 #define LoadI(i)      PushI((S32)t.load((U16)i, (S32)0))
-#define LoadL(i)      PushL((S64)t.load((U16)i, (S64)0))
-#define LoadF(i)      (t.na())
-#define LoadD(i)      (t.na())
+#define LoadL(i)      PushL(t.load2((U16)i))
+#define LoadF(i)      (t.push(t.load((U16)i, (S32)0)))    /** bits, no conversion */
+#define LoadD(i)      PushL(t.load2((U16)i))
 #define LoadA(i)      PushI((P32)t.load((U16)i, (P32)0))
 #define StorI(i)      (t.store((U16)i, PopI()))
-#define StorL(i)      (t.store((U16)i, PopL()))
-#define StorF(i)      (t.na())
-#define StorD(i)      (t.na())
+#define StorL(i)      (t.store2((U16)i, PopL()))
+#define StorF(i)      (t.store((U16)i, (S32)t.pop()))
+#define StorD(i)      (t.store2((U16)i, PopL()))
 #define StorA(i)      (t.store((U16)i, PopA()))
 ///
-/// array access macros (CC: TODO)
+/// array access macros, elements at natural width
 ///
-#define GetI_A(a,i)   PushI(*t.aload(a,i))
-#define GetL_A(i)     PushL((S64)0)
-#define GetF_A(i)     PushF((F32)0)
-#define GetD_A(i)     PushD((F64)0)
-#define GetA_A(a,i)   PushA(*t.aload(a,i))
-#define GetB_A(i)     PushI((U8)0)
-#define GetC_A(i)     PushI((U16)0)
-#define GetS_A(i)     PushI((S16)0)
-#define PutI_A(a,i,v) (t.astore(a,i,v))
-#define PutL_A(i)     (t.na())
-#define PutF_A(i)     (t.na())
-#define PutD_A(i)     (t.na())
-#define PutA_A(a,i,r) (t.astore(a,i,r))
-#define PutB_A(i)     (t.na())
-#define PutC_A(i)     (t.na())
-#define PutS_A(i)     (t.na())
+#define GetI_A(a,i)   PushI(t.aget<S32>(a,i))
+#define GetL_A(a,i)   PushL(t.aget<S64>(a,i))
+#define GetF_A(a,i)   PushF(t.aget<F32>(a,i))
+#define GetD_A(a,i)   PushD(t.aget<F64>(a,i))
+#define GetA_A(a,i)   PushA(t.aget<DU>(a,i))
+#define GetB_A(a,i)   PushI(t.aget<S8>(a,i))
+#define GetC_A(a,i)   PushI(t.aget<U16>(a,i))
+#define GetS_A(a,i)   PushI(t.aget<S16>(a,i))
+#define PutI_A(a,i,v) (t.aput<S32>(a,i,v))
+#define PutL_A(a,i,v) (t.aput<S64>(a,i,v))
+#define PutF_A(a,i,v) (t.aput<F32>(a,i,v))
+#define PutD_A(a,i,v) (t.aput<F64>(a,i,v))
+#define PutA_A(a,i,r) (t.aput<DU>(a,i,r))
+#define PutB_A(a,i,v) (t.aput<S8>(a,i,(S8)v))
+#define PutC_A(a,i,v) (t.aput<U16>(a,i,(U16)v))
+#define PutS_A(a,i,v) (t.aput<S16>(a,i,(S16)v))
 ///
 /// Class method, field access macros
 ///
 #define J16           (t.wide ? t.fetch4() : t.fetch2())
+#define LockA()       (&OBJ(t.TOS ? (IU)t.TOS : throw "ERR: null monitor")->lock) /** object kept on stack (pinned) */
 #define J8            ((U16)t.fetch())
+#define CP64(j)       (((U64)t.J->getU32(t.J->offset((j) - 1) + 1) << 32) | \
+                       t.J->getU32(t.J->offset((j) - 1) + 5))  /** CONST_LONG/DOUBLE value */
 #define UCODE(s, g)   { s, [](Thread &t){ g; }, 0 }
 ///
+/// float/double compare, nan: result when either is NaN (unordered)
+///
+#define FCMP(m,n,nan) ((m) > (n) ? 1 : (m) == (n) ? 0 : (m) < (n) ? -1 : (nan))
+///
 /// micro-code (built-in methods)
 ///
 static Method _java[] = {
@@ -86,11 +91,11 @@ static Method _java[] = {
     /// @}
     /// @definegroup Load ops (CC: TODO)
     /// @{
-    /*10*/  UCODE("bipush",   PushI(J8)),
-    /*11*/  UCODE("sipush",   PushI(J16)),
-    /*12*/  UCODE("ldc",      PushI(J8)),
-    /*13*/  UCODE("ldcw",     PushI(J16)),
-    /*14*/  UCODE("ldc2_w",   {}),
+    /*10*/  UCODE("bipush",   PushI((S8)t.fetch())),
+    /*11*/  UCODE("sipush",   PushI((S16)J16)),
+    /*12*/  UCODE("ldc",      PushI(t.ldc(J8))),
+    /*13*/  UCODE("ldcw",     PushI(t.ldc(J16))),
+    /*14*/  UCODE("ldc2_w",   U16 j = t.fetch2(); PushL(CP64(j))),
     /*15*/  UCODE("iload",    LoadI(J8)),
     /*16*/  UCODE("lload",    LoadL(J8)),
     /*17*/  UCODE("fload",    LoadF(J8)),
@@ -117,20 +122,20 @@ static Method _java[] = {
     /*2C*/  UCODE("aload_2",  LoadA(2)),
     /*2D*/  UCODE("aload_3",  LoadA(3)),
     /*2E*/  UCODE("iaload",   IU i = PopI(); GetI_A(PopI(), i)),  /// fetch integer from arrayref
-    /*2F*/  UCODE("faload",   GetF_A()),
-    /*30*/  UCODE("laload",   GetL_A()),
-    /*31*/  UCODE("daload",   GetD_A()),
+    /*2F*/  UCODE("laload",   IU i = PopI(); GetL_A(PopI(), i)),
+    /*30*/  UCODE("faload",   IU i = PopI(); GetF_A(PopI(), i)),
+    /*31*/  UCODE("daload",   IU i = PopI(); GetD_A(PopI(), i)),
     /*32*/  UCODE("aaload",   IU i = PopI(); GetA_A(PopI(), i)),  /// fetch ref from array
-    /*33*/  UCODE("baload",   GetB_A()),
-    /*34*/  UCODE("caload",   GetC_A()),
-    /*35*/  UCODE("saload",   GetS_A()),
+    /*33*/  UCODE("baload",   IU i = PopI(); GetB_A(PopI(), i)),
+    /*34*/  UCODE("caload",   IU i = PopI(); GetC_A(PopI(), i)),
+    /*35*/  UCODE("saload",   IU i = PopI(); GetS_A(PopI(), i)),
     /// @}
     /// @definegroup Store ops (CC: TODO)
     /// @{
     /*36*/  UCODE("istore",   StorI(J8)),    // store int to variable[index]
-    /*37*/  UCODE("lstore",   {}),
-    /*38*/  UCODE("fstore",   {}),
-    /*39*/  UCODE("dstore",   {}),
+    /*37*/  UCODE("lstore",   StorL(J8)),
+    /*38*/  UCODE("fstore",   StorF(J8)),
+    /*39*/  UCODE("dstore",   StorD(J8)),
     /*3A*/  UCODE("astore",   StorI(J8)),    // store a arrayref to variable[index]
     /*3B*/  UCODE("istore_0", StorI(0)),     // store int to variable[0]
     /*3B*/  UCODE("istore_1", StorI(1)),
@@ -144,22 +149,22 @@ static Method _java[] = {
     /*44*/  UCODE("fstore_1", StorF(1)),
     /*45*/  UCODE("fstore_2", StorF(2)),
     /*46*/  UCODE("fstore_3", StorF(3)),
-    /*47*/  UCODE("dstore_0", StorF(0)),
-    /*48*/  UCODE("dstore_1", StorF(1)),
-    /*49*/  UCODE("dstore_2", StorF(2)),
-    /*4A*/  UCODE("dstore_3", StorF(3)),
+    /*47*/  UCODE("dstore_0", StorD(0)),
+    /*48*/  UCODE("dstore_1", StorD(1)),
+    /*49*/  UCODE("dstore_2", StorD(2)),
+    /*4A*/  UCODE("dstore_3", StorD(3)),
     /*4B*/  UCODE("astore_0", StorA(0)),    // store object reference to auto[0]
     /*4C*/  UCODE("astore_1", StorA(1)),
     /*4D*/  UCODE("astore_2", StorA(2)),
     /*4E*/  UCODE("astore_3", StorA(3)),
     /*4F*/  UCODE("iastore",  DU v = PopI(); IU i = PopI(); PutI_A(PopI(), i, v)),    // (arrayref,index,value) store int into array[index]
-    /*50*/  UCODE("lastore",  PutL_A()),
-    /*51*/  UCODE("fastore",  PutF_A()),
-    /*52*/  UCODE("dastore",  PutD_A()),
+    /*50*/  UCODE("lastore",  S64 v = PopL(); IU i = PopI(); PutL_A(PopI(), i, v)),
+    /*51*/  UCODE("fastore",  F32 v = PopF(); IU i = PopI(); PutF_A(PopI(), i, v)),
+    /*52*/  UCODE("dastore",  F64 v = PopD(); IU i = PopI(); PutD_A(PopI(), i, v)),
     /*53*/  UCODE("aastore",  DU r = PopI(); IU i = PopI(); PutA_A(PopI(), i, r)),
-    /*54*/  UCODE("bastore",  PutB_A()),
-    /*55*/  UCODE("castore",  PutC_A()),
-    /*56*/  UCODE("sastore",  PutS_A()),
+    /*54*/  UCODE("bastore",  DU v = PopI(); IU i = PopI(); PutB_A(PopI(), i, v)),
+    /*55*/  UCODE("castore",  DU v = PopI(); IU i = PopI(); PutC_A(PopI(), i, v)),
+    /*56*/  UCODE("sastore",  DU v = PopI(); IU i = PopI(); PutS_A(PopI(), i, v)),
     /// @}
     /// @definegroup Stack ops
     /// @{
@@ -167,69 +172,72 @@ static Method _java[] = {
     /*58*/  UCODE("pop2",     PopI(); PopI()),
     /*59*/  UCODE("dup",      PushI(TopS32)),
     /*5A*/  UCODE("dup_x1",   S32 n = t.ss.pop(); S32 s = TopS32; PushI(n); PushI(s)),
-    /*5B*/  UCODE("dup_x2",   {}),
-    /*5C*/  UCODE("dup2",     S32 n = TopS32; PushI(n); PushI(t.ss[-2]); TopS32 = n),
-    /*5D*/  UCODE("dup2_x1",  {}),
-    /*5E*/  UCODE("dup2_x2",  {}),
+    /*5B*/  UCODE("dup_x2",   DU a = t.TOS; DU b = t.ss[-1]; t.ss[-1] = t.ss[-2]; t.ss[-2] = a;
+                              t.TOS = b; PushI(a)),                     /// c b a => a c b a
+    /*5C*/  UCODE("dup2",     DU a = t.TOS; PushI(t.ss[-1]); PushI(a)),  /// b a => b a b a
+    /*5D*/  UCODE("dup2_x1",  DU a = t.TOS; DU b = t.ss[-1]; DU c = t.ss[-2];
+                              t.ss[-2] = b; t.ss[-1] = a; t.TOS = c; PushI(b); PushI(a)),
+    /*5E*/  UCODE("dup2_x2",  DU a = t.TOS; DU b = t.ss[-1]; DU c = t.ss[-2]; DU d = t.ss[-3];
+                              t.ss[-3] = b; t.ss[-2] = a; t.ss[-1] = d; t.TOS = c; PushI(b); PushI(a)),
     /*5F*/  UCODE("swap",     S64 n = t.ss.pop(); PushI(n)),
     /// @}
     /// @definegroup ALU Arithmetic ops
     /// @{
     /*60*/  UCODE("iadd", TopS32 += t.ss.pop()),
-    /*61*/  UCODE("ladd", {}),
-    /*62*/  UCODE("fadd", {}),
-    /*63*/  UCODE("dadd", {}),
+    /*61*/  UCODE("ladd", S64 n = PopL(); PushL(PopL() + n)),
+    /*62*/  UCODE("fadd", F32 n = PopF(); PushF(PopF() + n)),
+    /*63*/  UCODE("dadd", F64 n = PopD(); PushD(PopD() + n)),
     /*64*/  UCODE("isub", TopS32 = t.ss.pop() - TopS32),
-    /*65*/  UCODE("lsub", {}),
-    /*66*/  UCODE("fsub", {}),
-    /*67*/  UCODE("dsub", {}),
+    /*65*/  UCODE("lsub", S64 n = PopL(); PushL(PopL() - n)),
+    /*66*/  UCODE("fsub", F32 n = PopF(); PushF(PopF() - n)),
+    /*67*/  UCODE("dsub", F64 n = PopD(); PushD(PopD() - n)),
     /*68*/  UCODE("imul", TopS32 *= t.ss.pop()),
-    /*69*/  UCODE("lmul", {}),
-    /*6A*/  UCODE("fmul", {}),
-    /*6B*/  UCODE("dmul", {}),
-    /*6C*/  UCODE("idiv", TopS32 = t.ss.pop() / TopS32),
-    /*6D*/  UCODE("ldiv", {}),
-    /*6E*/  UCODE("fdiv", {}),
-    /*6F*/  UCODE("ddiv", {}),
-    /*70*/  UCODE("irem", TopS32 = t.ss.pop() % TopS32),
-    /*71*/  UCODE("lrem", {}),
-    /*72*/  UCODE("frem", {}),
-    /*73*/  UCODE("drem", {}),
-    /*74*/  UCODE("ineg", TopS32 = -TopS32),
-    /*75*/  UCODE("lneg", {}),
-    /*76*/  UCODE("fneg", TopF32 = -TopF32),
-    /*77*/  UCODE("dneg", {}),
+    /*69*/  UCODE("lmul", S64 n = PopL(); PushL(PopL() * n)),
+    /*6A*/  UCODE("fmul", F32 n = PopF(); PushF(PopF() * n)),
+    /*6B*/  UCODE("dmul", F64 n = PopD(); PushD(PopD() * n)),
+    /*6C*/  UCODE("idiv", S32 n = TopS32; S32 m = t.ss.pop(); TopS32 = n == -1 ? (S32)(0U - (U32)m) : m / n),
+    /*6D*/  UCODE("ldiv", S64 n = PopL(); S64 m = PopL(); PushL(n == -1 ? 0ULL - (U64)m : m / n)),
+    /*6E*/  UCODE("fdiv", F32 n = PopF(); PushF(PopF() / n)),
+    /*6F*/  UCODE("ddiv", F64 n = PopD(); PushD(PopD() / n)),
+    /*70*/  UCODE("irem", S32 n = TopS32; S32 m = t.ss.pop(); TopS32 = n == -1 ? 0 : m % n),
+    /*71*/  UCODE("lrem", S64 n = PopL(); S64 m = PopL(); PushL(n == -1 ? 0 : m % n)),
+    /*72*/  UCODE("frem", F32 n = PopF(); PushF(fmodf(PopF(), n))),
+    /*73*/  UCODE("drem", F64 n = PopD(); PushD(fmod(PopD(), n))),
+    /*74*/  UCODE("ineg", TopU32 = 0U - TopU32),
+    /*75*/  UCODE("lneg", PushL(0ULL - (U64)PopL())),
+    /*76*/  UCODE("fneg", PushF(-PopF())),
+    /*77*/  UCODE("dneg", PushD(-PopD())),
     /// @}
     /// @definegroup ALU Logical ops
     /// @{
-    /*78*/  UCODE("ishl", TopS32 = t.ss.pop() << TopS32),
-    /*79*/  UCODE("lshl", {}),
-    /*7A*/  UCODE("ishr", TopS32 = t.ss.pop() >> TopS32),
-    /*7B*/  UCODE("lshr", {}),
-    /*7C*/  UCODE("iushr",TopU32 = (U32)t.ss.pop() >> TopS32),
-    /*7D*/  UCODE("lushr",{}),
+    /*78*/  UCODE("ishl", TopU32 = (U32)t.ss.pop() << (TopU32 & 31)),
+    /*79*/  UCODE("lshl", S32 n = PopI(); PushL((U64)PopL() << (n & 63))),
+    /*7A*/  UCODE("ishr", TopS32 = t.ss.pop() >> (TopU32 & 31)),
+    /*7B*/  UCODE("lshr", S32 n = PopI(); PushL(PopL() >> (n & 63))),
+    /*7C*/  UCODE("iushr",TopU32 = (U32)t.ss.pop() >> (TopU32 & 31)),
+    /*7D*/  UCODE("lushr",S32 n = PopI(); PushL((U64)PopL() >> (n & 63))),
     /*7E*/  UCODE("iand", TopU32 = t.ss.pop() & TopU32),
-    /*7F*/  UCODE("land", {}),
+    /*7F*/  UCODE("land", S64 n = PopL(); PushL(PopL() & n)),
     /*80*/  UCODE("ior",  TopU32 = t.ss.pop() | TopU32),
-    /*81*/  UCODE("lor",  {}),
+    /*81*/  UCODE("lor",  S64 n = PopL(); PushL(PopL() | n)),
     /*82*/  UCODE("ixor", TopU32 = t.ss.pop() ^ TopU32),
-    /*83*/  UCODE("lxor", {}),
+    /*83*/  UCODE("lxor", S64 n = PopL(); PushL(PopL() ^ n)),
     /*84*/  UCODE("iinc", t.iinc()),
     /// @}
     /// @definegroup ALU Conversion ops
     /// @{
-    /*85*/  UCODE("i2l",  {}),
-    /*86*/  UCODE("i2f",  {}),
+    /*85*/  UCODE("i2l",  PushL(PopI())),
+    /*86*/  UCODE("i2f",  PushF(PopI())),
     /*87*/  UCODE("i2d",  PushD(PopI())),
-    /*88*/  UCODE("l2i",  PushI(PopL())),
-    /*89*/  UCODE("l2f",  {}),
-    /*8A*/  UCODE("l2d",  {}),
-    /*8B*/  UCODE("f2i",  {}),
-    /*8C*/  UCODE("f2l",  {}),
-    /*8D*/  UCODE("f2d",  {}),
-    /*8E*/  UCODE("d2i",  {}),
-    /*8F*/  UCODE("d2l",  {}),
-    /*90*/  UCODE("d2f",  {}),
+    /*88*/  UCODE("l2i",  PushI((S32)PopL())),
+    /*89*/  UCODE("l2f",  PushF(PopL())),
+    /*8A*/  UCODE("l2d",  PushD(PopL())),
+    /*8B*/  UCODE("f2i",  PushI(f2i(PopF()))),
+    /*8C*/  UCODE("f2l",  PushL(f2l(PopF()))),
+    /*8D*/  UCODE("f2d",  PushD(PopF())),
+    /*8E*/  UCODE("d2i",  PushI(f2i(PopD()))),
+    /*8F*/  UCODE("d2l",  PushL(f2l(PopD()))),
+    /*90*/  UCODE("d2f",  PushF(PopD())),
     /*91*/  UCODE("i2b",  PushI((S8)PopI())),
     /*92*/  UCODE("i2c",  PushI((U16)PopI())),
     /*93*/  UCODE("i2s",  PushI((S16)PopI())),
@@ -238,12 +246,12 @@ static Method _java[] = {
     /// @{
     /*94*/  UCODE("lcmp",
                   S64 n = PopL();
-                  S64 d = PopL() - n;
-                  PushI(d < 0 ? 1 : ((d > 0) ? -1 : 0))),
-    /*95*/  UCODE("fcmpl", {}),
-    /*96*/  UCODE("fcmpg", {}),
-    /*97*/  UCODE("dcmpl", {}),
-    /*98*/  UCODE("dcmpg", {}),
+                  S64 m = PopL();
+                  PushI(m < n ? -1 : (m > n ? 1 : 0))),
+    /*95*/  UCODE("fcmpl", F32 n = PopF(); F32 m = PopF(); PushI(FCMP(m, n, -1))),
+    /*96*/  UCODE("fcmpg", F32 n = PopF(); F32 m = PopF(); PushI(FCMP(m, n, 1))),
+    /*97*/  UCODE("dcmpl", F64 n = PopD(); F64 m = PopD(); PushI(FCMP(m, n, -1))),
+    /*98*/  UCODE("dcmpg", F64 n = PopD(); F64 m = PopD(); PushI(FCMP(m, n, 1))),
     /// @}
     /// @definegroup ALU Logical Compare ops
     /// @{
@@ -282,10 +290,10 @@ static Method _java[] = {
     /// @}
     /// @definegroup Field Fetch ops
     /// @{
-    /*B2*/  UCODE("getstatic", PushI(*t.cls_var())),                   /// fetch from class variable
-    /*B3*/  UCODE("putstatic", *t.cls_var() = PopI()),                 /// store into class variable
-    /*B4*/  UCODE("getfield",  PushI(*t.inst_var(PopI()))),            /// fetch from instance variable
-    /*B5*/  UCODE("putfield",  S32 v = PopI(); *t.inst_var(PopI())=v), /// store into instance variable
+    /*B2*/  UCODE("getstatic", t.getstatic()),                          /// fetch from class variable
+    /*B3*/  UCODE("putstatic", t.putstatic()),                          /// store into class variable
+    /*B4*/  UCODE("getfield",  t.getfield()),                           /// fetch from instance variable
+    /*B5*/  UCODE("putfield",  t.putfield()),                           /// store into instance variable
     /// @}
     /// @definegroup Method/Interface Invocation ops
     /// @{
@@ -305,17 +313,33 @@ static Method _java[] = {
     /// @}
     /// @definegroup Misc ops
     /// @{
-    /*C0*/  UCODE("checkcast",    {}),
+    /*C0*/  UCODE("checkcast",    t.fetch2()),   /// no type check, reference stays
     /*C1*/  UCODE("instanceof",   {}),
-    /*C2*/  UCODE("monitorenter", {}),
-    /*C3*/  UCODE("monitorexit",  {}),
+    /*C2*/  UCODE("monitorenter", gMon.enter(t, LockA()); PopA()),
+    /*C3*/  UCODE("monitorexit",  gMon.leave(t, LockA()); PopA()),
     /*C4*/  UCODE("wide",         t.wide = true),
     /*C5*/  UCODE("multianewarray", {}),
     /*C6*/  UCODE("ifnull",       t.cjmp(PopA() == 0)),
     /*C7*/  UCODE("ifnonnull",    t.cjmp(PopA() != 0)),
     /*C8*/  UCODE("goto_w",       t.jmp()),
     /*C9*/  UCODE("jsr_w",        PushI((P32)(t.IP + sizeof(U32))); t.jmp()),
-    /*CA*/  UCODE("<init>",       {})
+    /*CA*/  UCODE("<init>",       {}),
+    /// @}
+    /// @definegroup Quick ops (rewritten from resolved call/field sites)
+    /// @{
+    /*CB*/  UCODE("invoke_q",     t.invoke_q(0)),
+    /*CC*/  UCODE("invokei_q",    t.invoke_q(2)),
+    /*CD*/  UCODE("getstatic_q",  PushI(*t.cls_var_q())),
+    /*CE*/  UCODE("putstatic_q",  *t.cls_var_q() = PopI()),
+    /*CF*/  UCODE("getfield_q",   PushI(*(DU*)t.inst_var_q(PopI()))),
+    /*D0*/  UCODE("putfield_q",   S32 v = PopI(); *(DU*)t.inst_var_q(PopI())=v),
+    /*D1*/  UCODE("invokev_q",    t.invoke_v(t.fetch2())),
+    /*D2*/  UCODE("getfield_b",   PushI(*(S8*)t.inst_var_q(PopI()))),
+    /*D3*/  UCODE("getfield_c",   PushI(*(U16*)t.inst_var_q(PopI()))),
+    /*D4*/  UCODE("getfield_s",   PushI(*(S16*)t.inst_var_q(PopI()))),
+    /*D5*/  UCODE("putfield_b",   S32 v = PopI(); *(S8*)t.inst_var_q(PopI())=(S8)v),
+    /*D6*/  UCODE("putfield_s",   S32 v = PopI(); *(S16*)t.inst_var_q(PopI())=(S16)v)
+    /// @}
 };
 ///
 /// microcode ROM, use extern by main program
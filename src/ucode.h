@@ -3,7 +3,23 @@
 #include "thread.h"       // include core.h, loader.h
 #include "mmu.h"          // memory pool manager
 
-#define OP_RETURN 0xb1
+#define OP_LRETURN 0xad
+#define OP_DRETURN 0xaf
+#define OP_RETURN  0xb1
+enum {                                      /// quick opcodes (private, after 0xca)
+    OP_INVOKE_Q = 0xcb,                     /// operand: gPool.vt index
+    OP_INVOKEI_Q,                           /// operand: gPool.vt index (+2 bytes)
+    OP_GETSTATIC_Q,                         /// operand: pmem offset of class var
+    OP_PUTSTATIC_Q,
+    OP_GETFIELD_Q,                          /// operand: instance var slot
+    OP_PUTFIELD_Q,
+    OP_INVOKEV_Q,                           /// operand: gPool.ic index
+    OP_GETFIELD_B,                          /// operand: instance field offset (bytes)
+    OP_GETFIELD_C,
+    OP_GETFIELD_S,
+    OP_PUTFIELD_B,
+    OP_PUTFIELD_S
+};
 enum { DOVAR = 0, DOLIT, DOSTR, UNNEST };   /// Forth opcodes
 
 struct Ucode {
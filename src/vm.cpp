@@ -0,0 +1,21 @@
+#include "vm.h"
+#include "thread.h"     // Thread
+#include "task.h"       // task_new, task_free
+
+static void null_con(int, const char *) {}             /// null console
+static void send_to_con(int, const char *msg) { LOG(msg); }
+
+VM::VM() : jout_cb(null_con), fout_cb(send_to_con) {
+    memset(clsfile, 0, sizeof(clsfile));
+    t0    = new Thread;
+    sched = task_new();
+}
+VM::~VM() {
+    task_free(sched);
+    delete t0;
+    for (int i = 0; i < ncls; i++) delete clsfile[i];
+}
+static VM _vm0;                      /// default VM
+__thread VM *gVM = &_vm0;
+
+void vm_use(VM *vm) { gVM = vm ? vm : &_vm0; }
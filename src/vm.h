@@ -0,0 +1,69 @@
+///
+/// @brief nanoJVM instance, everything a running VM owns
+/// Note:
+///   * dictionary and heap (Pool), loaded class files, collector, monitors,
+///     channels, tracer, profiler, main thread, thread table and console streams
+///   * microcode ROMs (uCode, uForth, uThread, uChannel, uESP32) stay shared, read-only
+///   * gVM is the VM of the calling native thread, gPool, gGC, gMon, gChan,
+///     gTrace and gProf are its parts, a thread started by java/lang/Thread
+///     inherits it, i.e. VMs on separate native threads never share state
+///   * a default VM is current on every native thread until vm_use()
+///
+#ifndef NANOJVM_VM_H
+#define NANOJVM_VM_H
+#include <sstream>      // stringstream
+#include <string>       // string class (for TIB)
+#include "mmu.h"
+#include "loader.h"
+#include "gc.h"
+#include "monitor.h"
+#include "channel.h"
+#include "trace.h"
+#include "profile.h"
+
+struct Sched;                     /// thread table and scheduler, see task.cpp
+
+struct VM {
+    Pool       pool;              /// dictionary, constants and object heap
+    ClassFile  *clsfile[CLSFILE_MAX];
+    int        ncls    = 0;       /// class files loaded
+    GC         gc;
+    Monitors   mon;
+    Channels   chan;
+    Tracer     trace;
+    Profiler   prof;
+    Thread     *t0;               /// main thread
+    Sched      *sched;            /// threads started by java/lang/Thread
+    S32        quantum = VM_QUANTUM;  /// opcodes per time slice
+    ///
+    /// console streams and callbacks
+    ///
+    std::ostringstream jout;      /// JVM output stream
+    void (*jout_cb)(int, const char*);
+    std::istringstream fin;       /// forth_in
+    std::ostringstream fout;      /// forth_out
+    std::string        tib;       /// terminal input buffer
+    void (*fout_cb)(int, const char*);
+
+    VM();
+    ~VM();
+};
+extern __thread VM *gVM;          /// current VM, no TLS init wrapper
+
+void vm_use(VM *vm);              /// make vm current on the calling native thread
+///
+/// parts of the current VM
+///
+#define gPool     (gVM->pool)
+#define gGC       (gVM->gc)
+#define gMon      (gVM->mon)
+#define gChan     (gVM->chan)
+#define gTrace    (gVM->trace)
+#define gProf     (gVM->prof)
+#define gT0       (*gVM->t0)
+///
+/// class files of the current VM
+///
+inline int       Loader::active()      { return gVM->ncls ? gVM->ncls - 1 : 0; }
+inline ClassFile *Loader::get(int jcf) { return gVM->clsfile[jcf]; }
+#endif // NANOJVM_VM_H
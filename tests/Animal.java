@@ -0,0 +1,5 @@
+class Animal
+{
+    int legs()  { return 4; }           // 07 ac
+    int speak() { return 1; }           // 04 ac
+}
@@ -0,0 +1,5 @@
+class Base
+{
+    int f() { return 1; }
+    int g() { return 2; }
+}
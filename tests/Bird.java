@@ -0,0 +1,4 @@
+class Bird extends Animal
+{
+    int legs()  { return 2; }           // 05 ac, speak() inherited
+}
@@ -0,0 +1,8 @@
+class Boom
+{
+    public static void main(String[] av) {
+        Sleeper s = new Sleeper(1, 20);
+        s.start();
+        s.start();                      // throws, the job fails with s running
+    }
+}
@@ -0,0 +1,18 @@
+class Box
+{
+    int     v;
+    boolean full;
+
+    synchronized void put(int x) throws InterruptedException {
+        while (full) wait();            // until taken
+        v    = x;
+        full = true;
+        notifyAll();
+    }
+    synchronized int take() throws InterruptedException {
+        while (!full) wait();           // until put
+        full = false;
+        notifyAll();
+        return v;
+    }
+}
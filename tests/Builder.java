@@ -0,0 +1,18 @@
+class Builder extends Thread
+{
+    int  n;
+    Node head;                          // list built by this thread
+
+    Builder(int n) { this.n = n; }
+
+    public void run() {
+        for (int i=0; i<n; i++) {
+            Node x = new Node();        // from this thread's TLAB
+            x.v    = i;
+            x.next = head;
+            head   = x;
+            int[] g = new int[6];       // garbage, gc retires every TLAB
+            if ((i & 31) == 0) Thread.yield();
+        }
+    }
+}
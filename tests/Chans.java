@@ -0,0 +1,32 @@
+import ej32.Channel;
+
+class Chans
+{
+    public static void main(String[] av) throws InterruptedException {
+        Channel c = new Channel(4);
+        System.out.println(c.tryRecv(-7));      // -7, empty
+        c.send(5);
+        c.send(6);
+        System.out.println(c.size());           // 2
+        System.out.println(c.recv() + c.tryRecv(0));  // 11
+        Sensor s = new Sensor(c, 100);          // sensor feeds controller
+        s.start();
+        int sum = 0;
+        for (int v = c.recv(); v >= 0; v = c.recv()) sum += v;
+        s.join();
+        System.out.println(sum);                // 328350
+        Channel d = new Channel(8);             // fan-in, gc while arrays in flight
+        Feeder[] f = new Feeder[3];
+        for (int i=0; i<3; i++) {
+            f[i] = new Feeder(d);
+            f[i].start();
+        }
+        sum = 0;
+        for (int i=0; i<900; i++) {
+            int[] a = (int[])d.recvObj();
+            sum += a[7];
+        }
+        for (int i=0; i<3; i++) f[i].join();
+        System.out.println(sum);                // 134550
+    }
+}
@@ -0,0 +1,20 @@
+class Churn
+{
+    public static void main(String[] av) {
+        int[][] keep = new int[16][];
+        int len = 0;
+        for (int i=0; i<2000; i++) {
+            int[] a = new int[i % 7 + 1];   // 7 size classes churned
+            a[0] = i;
+            len += a.length;
+            if (i % 50 == 0) keep[(i / 50) % 16] = a;   // scattered survivors
+        }
+        int[] big = new int[3000];          // fits only after compaction
+        big[2999] = 1;
+        int s = 0;
+        for (int k=0; k<16; k++) s += keep[k][0];
+        System.out.println(len);            // 7995
+        System.out.println(s);              // 25200
+        System.out.println(big[2999]);      // 1
+    }
+}
@@ -0,0 +1,8 @@
+class Counter implements Runnable
+{
+    int n;
+
+    public void run() {
+        for (int i=0; i<1000; i++) n += i;
+    }
+}
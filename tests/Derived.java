@@ -0,0 +1,3 @@
+class Derived extends Base
+{
+}
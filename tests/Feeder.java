@@ -0,0 +1,16 @@
+import ej32.Channel;
+
+class Feeder extends Thread
+{
+    Channel out;
+
+    Feeder(Channel out) { this.out = out; }
+
+    public void run() {
+        for (int i=0; i<300; i++) {
+            int[] a = new int[8];               // only the channel refers to it
+            a[7] = i;
+            out.send(a);
+        }
+    }
+}
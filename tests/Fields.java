@@ -0,0 +1,16 @@
+class Fields
+{
+    public static void main(String[] av) {
+        Point3 p = new Point3();
+        Point  q = new Point();
+        p.z = 3;                        // fields touched out of declared order
+        p.y = 2;
+        p.x = 1;
+        q.x = 7;
+        Point3.count3 = 5;
+        Point.count   = 4;
+        System.out.println(p.x * 100 + p.y * 10 + p.z);     // 123
+        System.out.println(q.x);                            // 7
+        System.out.println(Point.count * 10 + Point3.count3); // 45
+    }
+}
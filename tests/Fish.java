@@ -0,0 +1,5 @@
+class Fish extends Animal
+{
+    int legs()  { return 0; }           // 03 ac
+    int speak() { return 3; }           // 06 ac
+}
@@ -0,0 +1,75 @@
+class Floats
+{
+    static double total;                // two cells of class storage
+    float  kp, ki, kd, prev;            // one cell each
+    double integ;
+
+    Floats(float p, float i, float d) { kp = p; ki = i; kd = d; }
+
+    float step(float err, float dt) {   // PID controller step
+        integ += err * dt;
+        float der = (err - prev) / dt;
+        prev = err;
+        return (float)(kp * err + ki * integ + kd * der);
+    }
+    static double hyp(double a, float b, double c) {
+        return a * a + b * b + c % 2.0;
+    }
+    static int    f2i(float v)  { return (int)v; }     // operands are parameters,
+    static int    d2i(double v) { return (int)v; }     // javac would fold constants
+    static long   f2l(float v)  { return (long)v; }
+    static long   d2l(double v) { return (long)v; }
+    static float  l2f(long v)   { return v; }
+    static double l2d(long v)   { return v; }
+    static float  frem(float a, float b)   { return a % b; }
+    static double drem(double a, double b) { return a % b; }
+    static int    lt(float a, float b)     { return a < b ? -1 : 0; }  // fcmpg, ifge
+    static int    gt(float a, float b)     { return a > b ? 1 : 0; }   // fcmpl, ifle
+    static int    dlt(double a, double b)  { return a < b ? -1 : 0; }  // dcmpg, ifge
+    static int    dgt(double a, double b)  { return a > b ? 1 : 0; }   // dcmpl, ifle
+    public static void main(String[] av) {
+        Floats pid = new Floats(0.6f, 0.1f, 0.05f);
+        float  y   = 0;
+        for (int i = 0; i < 50; i++) {  // first order plant
+            float u = pid.step(1.0f - y, 0.1f);
+            y += (u - y) * 0.2f;
+        }
+        System.out.println(y);                              // 0.5427694
+        System.out.println(pid.integ);                      // 2.7983415946364403
+
+        double[] d = new double[4];
+        float[]  f = new float[4];
+        for (int i = 0; i < 4; i++) {
+            d[i] = i * 0.25;
+            f[i] = i / 3.0f;
+            total += d[i] + f[i];
+        }
+        System.out.println(total);                          // 3.5000000298023224
+        System.out.println(hyp(3.0, 4.0f, 7.5));            // 26.5
+        System.out.println(3.14159f);                       // 3.14159 (ldc)
+        System.out.println(100000);                         // 100000 (ldc)
+        System.out.println(frem(7.5f, 2f));                 // 1.5
+        System.out.println(drem(-7.5, 2.0));                // -1.5
+        System.out.println(f2i(3.99f));                     // 3
+        System.out.println(d2i(-2.5));                      // -2
+        System.out.println(d2i(1e20));                      // 2147483647
+        System.out.println(d2l(1e19));                      // 9223372036854775807
+        System.out.println(f2l(-3.7f));                     // -3
+        System.out.println(l2f(1L << 40));                  // 1.0995116E12
+        System.out.println(l2d(1L << 40));                  // 1.099511627776E12
+        System.out.println(f[1]);                           // 0.33333334
+        System.out.println(-0.1);                           // -0.1
+
+        float nan = 0f / 0f;
+        System.out.println(nan);                            // NaN
+        System.out.println(lt(nan, 1f));                    // 0, NaN is unordered
+        System.out.println(gt(nan, 1f));                    // 0
+        System.out.println(dlt(nan, 1.0));                  // 0
+        System.out.println(dgt(nan, 1.0));                  // 0
+        System.out.println(lt(2.5f, 3.5f));                 // -1
+        System.out.println(gt(2.5f, 3.5f));                 // 0
+        System.out.println(1e-5f);                          // 1.0E-5
+        System.out.println(-1.0);                           // -1.0
+        System.out.println((float)(double)-y);              // -0.5427694
+    }
+}
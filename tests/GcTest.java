@@ -0,0 +1,28 @@
+class GcTest
+{
+    static Node keep;
+
+    public static void main(String[] av) {
+        int[] g     = new int[8];           // garbage in front of local
+        int[] local = new int[4];           // held by a stack slot, pinned
+        local[1] = 7;
+        for (int i=0; i<10; i++) {          // list nodes with garbage in between
+            g = new int[8];
+            Node n = new Node();
+            n.v    = i;
+            n.next = keep;
+            keep   = n;
+        }
+        int sum = 0;
+        for (int i=0; i<3000; i++) {        // ~120KB through a 16KB heap
+            g = new int[8];
+            g[0] = i;
+            sum += g[0] & 1;
+        }
+        int s = 0;
+        for (Node n = keep; n != null; n = n.next) s += n.v;
+        System.out.println(sum);            // 1500
+        System.out.println(s);              // 45
+        System.out.println(local[1]);       // 7
+    }
+}
@@ -0,0 +1,13 @@
+class Incr extends Thread
+{
+    SyncCounter c;
+
+    Incr(SyncCounter c) { this.c = c; }
+
+    public void run() {
+        for (int i=0; i<500; i++) {
+            c.inc2();
+            SyncCounter.sinc();
+        }
+    }
+}
@@ -0,0 +1,66 @@
+class Longs
+{
+    static long total;                  // two cells of class storage
+    long   acc;                         // 8 bytes in the instance
+
+    static long fib(int n) {
+        long a = 0, b = 1;              // two local slots each
+        for (int i = 0; i < n; i++) {
+            long c = a + b;
+            a = b;
+            b = c;
+        }
+        return a;
+    }
+    long add(long v, int k) {
+        acc += v * k;
+        return acc;
+    }
+    static long mix(long a, int s, long b) {
+        return ((a << s) ^ (b >>> s)) | (a >> 60);
+    }
+    static long quot(long a, long b) { return a / b; }
+    static long rem(long a, long b)  { return a % b; }
+    static int  iquot(int a, int b)  { return a / b; }
+    static int  irem(int a, int b)   { return a % b; }
+    static int  ishift(int a, int s) {
+        return (a << s) ^ (a >> s) ^ (a >>> s);
+    }
+    public static void main(String[] av) throws InterruptedException {
+        Longs o = new Longs();
+        System.out.println(fib(90));                        // 2880067194370816120
+        long big = 10000000000L;
+        System.out.println(big / 7);                        // 1428571428
+        System.out.println(big % 7);                        // 4
+        System.out.println(-big);                           // -10000000000
+        for (int i = 1; i <= 4; i++) o.add(big, i);
+        System.out.println(o.acc);                          // 100000000000
+
+        long[] a = new long[5];
+        for (int i = 0; i < 5; i++) {
+            a[i] = (long)i << 40;
+            total += a[i];
+        }
+        System.out.println(total);                          // 10995116277760
+        System.out.println((int)(total >>> 32));            // 2560
+        System.out.println(mix(0x7123456789ABCDEFL, 4, -2L)); // 2146996046356750607
+
+        long r = (o.acc = big + 1);                         // dup2_x1
+        System.out.println(r > big ? 1 : -1);               // 1 (lcmp)
+        System.out.println(big > o.acc ? 1 : -1);           // -1
+        r = (a[0] = big);                                   // dup2_x2
+        System.out.println(r + a[0]);                       // 20000000000
+        int n = 5;
+        System.out.println((long)n * 1000000000);           // 5000000000
+
+        System.out.println(quot(Long.MIN_VALUE, -1));       // -9223372036854775808, no trap
+        System.out.println(rem(Long.MIN_VALUE, -1));        // 0
+        System.out.println(iquot(Integer.MIN_VALUE, -1));   // -2147483648
+        System.out.println(irem(Integer.MIN_VALUE, -1));    // 0
+        System.out.println(mix(0x7123456789ABCDEFL, 68, -2L)); // 2146996046356750607, count & 63
+        System.out.println(ishift(-3, 33));                 // 2147483642, count & 31
+        int k;
+        for (k = 0; k < 300; k++) Thread.sleep(0);          // pops both cells, or ss overflows
+        System.out.println(k);                              // 300
+    }
+}
@@ -0,0 +1,5 @@
+class Node
+{
+    int  v;
+    Node next;
+}
@@ -0,0 +1,5 @@
+class Other                             // g()I as in Base, but not related
+{
+    int g() { return 30; }
+    int h() { return 40; }
+}
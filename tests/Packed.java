@@ -0,0 +1,32 @@
+class Packed
+{
+    byte    b;                          // declared out of size order
+    int     i;
+    short   s;
+    boolean z;
+    char    c;
+
+    public static void main(String[] av) {
+        byte[]  ba = new byte[3];
+        char[]  ca = new char[3];
+        short[] sa = new short[3];
+        ba[1] = -56;
+        ca[1] = (char)-2000;
+        sa[1] = -300;
+        System.out.println(ba[1]);                          // -56
+        System.out.println(ca[1]);                          // 63536
+        System.out.println(sa[1] + ba[0]);                  // -300
+
+        Packed p   = new Packed();
+        int    sum = 0;
+        for (int k = 0; k < 2; k++) {   // 2nd pass runs quickened opcodes
+            p.b = -1;
+            p.s = -300;
+            p.c = 65;
+            p.i = 30000;
+            p.z = true;
+            sum += p.b + p.s + p.c + p.i + (p.z ? 1 : 0);
+        }
+        System.out.println(sum);                            // 59530
+    }
+}
@@ -0,0 +1,6 @@
+class Point
+{
+    static int count;                   // cv slot 0
+    int x;                              // iv slot 0
+    int y;                              // iv slot 1
+}
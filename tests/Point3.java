@@ -0,0 +1,5 @@
+class Point3 extends Point
+{
+    static int count3;                  // cv slot 0 (own storage)
+    int z;                              // iv slot 2, after Point.x, Point.y
+}
@@ -0,0 +1,14 @@
+class Poly
+{
+    static int sum(Animal a) {
+        return a.legs() * 10 + a.speak();   // one call site per method, 3 receiver classes
+    }
+    public static void main(String[] av) {
+        Animal a = new Animal();
+        Animal b = new Bird();
+        Animal f = new Fish();
+        System.out.println(sum(a));     // 41
+        System.out.println(sum(b));     // 21
+        System.out.println(sum(f));     // 3
+    }
+}
@@ -0,0 +1,12 @@
+class Producer extends Thread
+{
+    Box b;
+
+    Producer(Box b) { this.b = b; }
+
+    public void run() {
+        try {
+            for (int i=1; i<=100; i++) b.put(i);
+        } catch (InterruptedException e) {}
+    }
+}
@@ -0,0 +1,14 @@
+import ej32.Channel;
+
+class Sensor extends Thread
+{
+    Channel out;
+    int     n;
+
+    Sensor(Channel out, int n) { this.out = out; this.n = n; }
+
+    public void run() {
+        for (int i=0; i<n; i++) out.send(i * i);   // parks while the ring is full
+        out.send(-1);                               // end of readings
+    }
+}
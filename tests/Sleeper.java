@@ -0,0 +1,15 @@
+import ej32.Forth;
+
+class Sleeper extends Thread
+{
+    static int order;                   // wake order, one digit per thread
+    int id;
+    int ms;
+
+    Sleeper(int id, int ms) { this.id = id; this.ms = ms; }
+
+    public void run() {
+        Forth.delay(ms);                // sleep queue, others keep running
+        order = order * 10 + id;
+    }
+}
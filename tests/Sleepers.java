@@ -0,0 +1,23 @@
+import ej32.Forth;
+
+class Sleepers
+{
+    public static void main(String[] av) throws InterruptedException {
+        Sleeper a = new Sleeper(1, 30);
+        Sleeper b = new Sleeper(2, 10);
+        Sleeper c = new Sleeper(3, 20);
+        Spinner s = new Spinner();
+        s.start();
+        a.start();
+        b.start();
+        c.start();
+        Forth.delay(50);                // main sleeps, VM does not
+        Spinner.stop = 1;
+        s.join();
+        a.join();
+        b.join();
+        c.join();
+        System.out.println(Sleeper.order);      // 231
+        System.out.println(s.n > 0 ? 1 : 0);    // 1
+    }
+}
@@ -0,0 +1,9 @@
+class Spinner extends Thread
+{
+    static int stop;
+    int n;
+
+    public void run() {
+        while (stop == 0) n++;          // preempted when its time slice expires
+    }
+}
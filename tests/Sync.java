@@ -0,0 +1,30 @@
+class Sync
+{
+    public static void main(String[] av) throws InterruptedException {
+        SyncCounter c = new SyncCounter();
+        Thread   x = new Incr(c);
+        Thread   y = new Incr(c);
+        Thread   z = new Incr(c);
+        Box      b = new Box();
+        Thread   q = new Producer(b);
+        x.start();
+        y.start();
+        z.start();
+        q.start();
+        int sum = 0;
+        int i   = 0;
+        while (i < 100) {               // wait/notifyAll hand-off
+            sum += b.take();
+            i++;
+        }
+        x.join();
+        y.join();
+        z.join();
+        q.join();
+        int n;
+        synchronized (c) { n = c.n; }
+        System.out.println(n);                  // 3000
+        System.out.println(SyncCounter.s);      // 1500
+        System.out.println(sum);                // 5050
+    }
+}
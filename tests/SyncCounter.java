@@ -0,0 +1,12 @@
+class SyncCounter
+{
+    static int s;
+    int n;
+
+    synchronized void inc() {
+        n++;
+        if ((n & 15) == 0) Thread.yield();      // switch while holding the lock
+    }
+    synchronized void inc2() { inc(); inc(); }  // reentrant
+    static synchronized void sinc() { s++; }    // locks the class
+}
@@ -0,0 +1,19 @@
+class Threads
+{
+    public static void main(String[] av) throws InterruptedException {
+        Worker  a = new Worker(1000);
+        Worker  b = new Worker(2000);
+        Counter c = new Counter();
+        Thread  t = new Thread(c);          // Runnable target
+        a.start();
+        b.start();
+        t.start();
+        Thread.sleep(5);                    // main gives up the VM
+        a.join();
+        b.join();
+        t.join();
+        System.out.println(a.acc);          // 499500
+        System.out.println(b.acc);          // 1999000
+        System.out.println(c.n);            // 499500
+    }
+}
@@ -0,0 +1,21 @@
+class Tlabs
+{
+    public static void main(String[] av) throws InterruptedException {
+        Builder[] b = new Builder[3];
+        for (int i=0; i<3; i++) {
+            b[i] = new Builder(150);
+            b[i].start();
+        }
+        int cnt = 0;
+        int sum = 0;
+        for (int i=0; i<3; i++) {
+            b[i].join();
+            for (Node x = b[i].head; x != null; x = x.next) {
+                cnt++;
+                sum += x.v;
+            }
+        }
+        System.out.println(cnt);            // 450
+        System.out.println(sum);            // 33525
+    }
+}
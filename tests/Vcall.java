@@ -0,0 +1,12 @@
+class Vcall
+{
+    public static void main(String[] av) {
+        Derived d = new Derived();
+        Base    b = d;
+        Other   o = new Other();
+        System.out.println(d.g());      // 2, Base.g found up from Derived
+        System.out.println(b.g());      // 2
+        System.out.println(o.g());      // 30
+        System.out.println(b.f());      // 1
+    }
+}
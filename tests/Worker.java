@@ -0,0 +1,16 @@
+class Worker extends Thread
+{
+    int n;
+    int acc;
+
+    Worker(int n) { this.n = n; }
+
+    public void run() {
+        for (int i=0; i<n; i++) {
+            int[] a = new int[8];           // garbage, gc runs in any thread
+            a[i & 7] = i;
+            acc += a[i & 7];
+            if ((i & 63) == 0) Thread.yield();
+        }
+    }
+}
@@ -0,0 +1,16 @@
+class BenchAlloc
+{
+    int x;
+    int y;
+
+    BenchAlloc(int x, int y) { this.x = x; this.y = y; }
+
+    public static void main(String[] av) {
+        int sum = 0;
+        for (int i=0; i<100; i++) {         // 100 objects per run
+            BenchAlloc o = new BenchAlloc(i, i + 1);
+            sum += o.y - o.x;
+        }
+        System.out.println(sum);
+    }
+}
@@ -0,0 +1,16 @@
+class BenchArray
+{
+    public static void main(String[] av) {
+        int a[] = new int[100];
+        int sum = 0;
+        for (int r=0; r<100; r++) {         // 100 x (fill 100 + sum 100)
+            for (int i=0; i<100; i++) {
+                a[i] = i + r;
+            }
+            for (int i=0; i<a.length; i++) {
+                sum += a[i];
+            }
+        }
+        System.out.println(sum);
+    }
+}
@@ -0,0 +1,17 @@
+class BenchArray2
+{
+    public static void main(String[] av) {
+        int m[][] = new int[10][];
+        for (int i=0; i<10; i++) m[i] = new int[10];
+        int sum = 0;
+        for (int r=0; r<100; r++) {         // 100 x 10 x 10 fill and sum
+            for (int i=0; i<10; i++) {
+                for (int j=0; j<10; j++) {
+                    m[i][j] = i * j + r;
+                    sum += m[i][j];
+                }
+            }
+        }
+        System.out.println(sum);
+    }
+}
@@ -0,0 +1,23 @@
+import ej32.Channel;
+
+class BenchFanin extends Thread
+{
+    static Channel ch;                      // 4 senders, 1 receiver
+
+    public void run() {
+        for (int i=0; i<1000; i++) ch.send(i);
+    }
+
+    public static void main(String[] av) throws InterruptedException {
+        ch = new Channel(64);
+        BenchFanin[] t = new BenchFanin[4];
+        for (int i=0; i<4; i++) {
+            t[i] = new BenchFanin();
+            t[i].start();
+        }
+        int n = 0;
+        for (; n<4000; n++) ch.recv();
+        for (int i=0; i<4; i++) t[i].join();
+        System.out.println(n);              // 4000 messages
+    }
+}
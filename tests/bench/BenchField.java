@@ -0,0 +1,17 @@
+class BenchField
+{
+    static int cnt;
+    int a;
+    int b;
+
+    public static void main(String[] av) {
+        BenchField o = new BenchField();
+        cnt = 0;
+        for (int i=0; i<10000; i++) {
+            o.a += i;                       // getfield, putfield
+            o.b = o.a - o.b;
+            cnt++;                          // getstatic, putstatic
+        }
+        System.out.println(o.b + cnt);
+    }
+}
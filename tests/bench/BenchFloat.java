@@ -0,0 +1,15 @@
+class BenchFloat
+{
+    static float run() {
+        float y = 0, integ = 0;
+        for (int i=0; i<30000; i++) {   // PI loop on a first order plant
+            float e = 1.0f - y;
+            integ += e * 0.01f;
+            y += (0.5f * e + 0.1f * integ - y) * 0.1f;
+        }
+        return y;
+    }
+    public static void main(String[] av) {
+        System.out.println(run());
+    }
+}
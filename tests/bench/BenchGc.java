@@ -0,0 +1,20 @@
+class BenchGc
+{
+    int     v;
+    BenchGc next;
+    static BenchGc keep;
+
+    public static void main(String[] av) {
+        keep = null;                        // list of the last run is garbage
+        for (int i=0; i<200; i++) {         // 200 nodes kept, 200 arrays dropped per run
+            int[]   g = new int[8];
+            BenchGc n = new BenchGc();
+            n.v    = i;
+            n.next = keep;
+            keep   = n;
+        }
+        int sum = 0;
+        for (BenchGc n = keep; n != null; n = n.next) sum += n.v;
+        System.out.println(sum);
+    }
+}
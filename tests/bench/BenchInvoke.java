@@ -0,0 +1,19 @@
+class BenchInvoke
+{
+    int acc;
+
+    static int add(int a, int b) { return a + b; }      // invokestatic
+    int inc(int v)               { return acc += v; }   // invokevirtual
+    private int twice(int v)     { return v + v; }      // invokespecial
+
+    public static void main(String[] av) {
+        BenchInvoke o = new BenchInvoke();
+        int s = 0;
+        for (int i=0; i<10000; i++) {       // 3 calls per iteration
+            s = add(s, i);
+            s = o.twice(s) - s;
+            o.inc(1);
+        }
+        System.out.println(s + o.acc);
+    }
+}
@@ -0,0 +1,13 @@
+class BenchLong
+{
+    static long run() {
+        long sum = 0;
+        for (int i=0; i<30000; i++) {
+            sum += (long)i * i;
+        }
+        return sum;
+    }
+    public static void main(String[] av) {
+        System.out.println(run());
+    }
+}
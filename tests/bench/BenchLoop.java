@@ -0,0 +1,13 @@
+class BenchLoop
+{
+    static int run() {
+        int sum = 0;
+        for (int i=0; i<30000; i++) {
+            sum += i;
+        }
+        return sum;
+    }
+    public static void main(String[] av) {
+        System.out.println(run());
+    }
+}
@@ -0,0 +1,12 @@
+class BenchNested
+{
+    public static void main(String[] av) {
+        int sum = 0;
+        for (int i=0; i<100; i++) {         // 100 x 300 iterations
+            for (int j=0; j<300; j++) {
+                sum += i * j;
+            }
+        }
+        System.out.println(sum);
+    }
+}
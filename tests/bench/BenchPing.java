@@ -0,0 +1,24 @@
+import ej32.Channel;
+
+class BenchPing extends Thread
+{
+    static Channel ping, pong;              // one-cell rings, strict hand-off
+
+    public void run() {
+        for (int i=0; i<1000; i++) pong.send(ping.recv() + 1);
+    }
+
+    public static void main(String[] av) throws InterruptedException {
+        ping = new Channel(1);
+        pong = new Channel(1);
+        BenchPing t = new BenchPing();
+        t.start();
+        int v = 0;
+        for (int i=0; i<1000; i++) {
+            ping.send(v);
+            v = pong.recv();
+        }
+        t.join();
+        System.out.println(v + v);          // 2000 messages
+    }
+}
@@ -0,0 +1,22 @@
+class BenchSync extends Thread
+{
+    static BenchSync lock;                  // shared monitor and counter
+    int n;
+
+    public void run() {
+        for (int i=0; i<1000; i++) {
+            synchronized (lock) { lock.n++; }
+        }
+    }
+
+    public static void main(String[] av) throws InterruptedException {
+        lock = new BenchSync();
+        BenchSync[] t = new BenchSync[4];   // 4 threads contend for one lock
+        for (int i=0; i<4; i++) {
+            t[i] = new BenchSync();
+            t[i].start();
+        }
+        for (int i=0; i<4; i++) t[i].join();
+        System.out.println(lock.n);         // 4000
+    }
+}
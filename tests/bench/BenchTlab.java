@@ -0,0 +1,26 @@
+class BenchTlab extends Thread
+{
+    int n;                                  // arrays allocated by this thread
+
+    public void run() {
+        for (int i=0; i<1000; i++) {
+            int[] a = new int[4];           // small, from the thread's TLAB
+            a[0] = i;
+            n++;
+        }
+    }
+
+    public static void main(String[] av) throws InterruptedException {
+        BenchTlab[] t = new BenchTlab[4];
+        for (int i=0; i<4; i++) {
+            t[i] = new BenchTlab();
+            t[i].start();
+        }
+        int sum = 0;
+        for (int i=0; i<4; i++) {
+            t[i].join();
+            sum += t[i].n;
+        }
+        System.out.println(sum);            // 4000
+    }
+}
@@ -0,0 +1,254 @@
+///
+/// @brief nanoJVM benchmark runner (host only)
+/// Note:
+///   * each workload runs in a forked child, i.e. a fresh VM every time
+///   * one counting pass on the reference engine gives bytecodes per run,
+///     the timed passes then run on the default (direct-threaded) engine
+///   * heap is not rewound between passes, the collector reclaims it
+///   * List::max watermarks are taken after the counting pass since the
+///     fast engine keeps its operand stack in registers
+///   * sync and talloc count lock entries or objects, ping and fanin channel
+///     messages (their printed result) as ops, i.e. ping gives one-way latency
+///   * vms runs main() in several VMs on native threads, ops of all of them
+///   * jobs submits each run as a job to an Executor, i.e. fresh VM, class
+///     load and main() per op, in place of a process per script
+///   * output is one JSON object per line, for tracking across releases
+///
+/// Build and run (from tests/bench):
+///   > g++ -std=c++17 -O2 -pthread -I../../src -o bench bench.cpp $(ls ../../src/*.cpp | grep -v main.cpp)
+///   > ./bench [-n<runs>] [workload ...]
+///
+#include <chrono>
+#include <string>
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "forth.h"
+#include "java.h"
+#include "vm.h"
+#include "exec.h"
+
+extern void forth_outer(Thread &t, const char *cmd);
+
+static std::string jbuf;                /// captured VM console output
+static void capture(int, const char *msg) { jbuf += msg; }
+
+struct Bench {
+    const char *name;                   /// workload name
+    const char *cls;                    /// class file (also context for Forth workloads)
+    const char *setup;                  /// Forth definitions (run once)
+    const char *cmd;                    /// Forth command, NULL to run main()
+    int        unit;                    /// what one op is, see UNIT_*
+    int        vms = 0;                 /// timed in this many VMs at once, 0: one
+};
+#define UNIT_BYTECODE 0                 /** bytecodes/words charged to time slice */
+#define UNIT_TOKEN    1                 /** tokens parsed by outer interpreter    */
+#define UNIT_CLASS    2                 /** class files loaded                    */
+#define UNIT_LOCK     3                 /** monitor entries, i.e. printed result  */
+#define UNIT_OBJ      4                 /** objects allocated, i.e. printed result */
+#define UNIT_JOB      5                 /** jobs run by an Executor of b.vms workers */
+#define UNIT_MSG      6                 /** channel messages, i.e. printed result  */
+static const char *unit_name[] = { "bytecode", "token", "class", "lock", "object", "job", "message" };
+static const Bench list[] = {
+    { "loop",      "BenchLoop.class",   0, 0, UNIT_BYTECODE },
+    { "nested",    "BenchNested.class", 0, 0, UNIT_BYTECODE },
+    { "long",      "BenchLong.class",   0, 0, UNIT_BYTECODE },
+    { "float",     "BenchFloat.class",  0, 0, UNIT_BYTECODE },
+    { "invoke",    "BenchInvoke.class", 0, 0, UNIT_BYTECODE },
+    { "field",     "BenchField.class",  0, 0, UNIT_BYTECODE },
+    { "array",     "BenchArray.class",  0, 0, UNIT_BYTECODE },
+    { "array2d",   "BenchArray2.class", 0, 0, UNIT_BYTECODE },
+    { "alloc",     "BenchAlloc.class",  0, 0, UNIT_BYTECODE },
+    { "gc",        "BenchGc.class",     0, 0, UNIT_BYTECODE },
+    { "sync",      "BenchSync.class",   0, 0, UNIT_LOCK },
+    { "talloc",    "BenchTlab.class",   0, 0, UNIT_OBJ },
+    { "ping",      "BenchPing.class",   0, 0, UNIT_MSG },
+    { "fanin",     "BenchFanin.class",  0, 0, UNIT_MSG },
+    { "vms",       "BenchLoop.class",   0, 0, UNIT_BYTECODE, 4 },
+    { "vmsync",    "BenchSync.class",   0, 0, UNIT_LOCK, 4 },
+    { "jobs",      "BenchLoop.class",   0, 0, UNIT_JOB, 4 },
+    { "colon",     "BenchLoop.class",
+      ": w1 1 iadd ; : w2 w1 w1 w1 w1 ; : w3 w2 w2 w2 w2 ; "
+      ": w4 w3 w3 w3 w3 ; : w5 w4 w4 w4 w4 ;",
+      "0 w5 w5 w5 w5", UNIT_BYTECODE },
+    { "outer",     "BenchLoop.class",   0,
+      "1 2 iadd 3 isub 4 imul 5 iadd 6 isub 7 imul 8 iadd 9 isub "
+      "2 iadd 3 isub 4 imul 5 iadd 6 isub 7 imul 8 iadd 9 isub", UNIT_TOKEN },
+    { "classload", "BenchInvoke.class", 0, 0, UNIT_CLASS }
+};
+#define NBENCH  (int)(sizeof(list)/sizeof(Bench))
+
+static double now_ns() {
+    return std::chrono::duration<double, std::nano>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+///
+/// count of whitespace separated tokens
+///
+static U32 tokens(const char *s) {
+    U32 n = 0;
+    for (bool in=false; *s; s++) {
+        bool sp = isspace((unsigned char)*s);
+        if (!sp && !in) n++;
+        in = !sp;
+    }
+    return n;
+}
+///
+/// last non-blank token of captured output, i.e. what main() printed
+///
+static std::string result(const std::string &s = jbuf) {
+    size_t e = s.find_last_not_of(" \r\n");
+    if (e == std::string::npos) return "";
+    size_t b = s.find_last_of(" \r\n", e);
+    return s.substr(b == std::string::npos ? 0 : b + 1, e - b);
+}
+///
+/// one pass of a workload, returns opcodes charged by the thread
+///
+static U32 pass(Thread &t, const Bench &b, IU mx) {
+    U32 n = t.icnt;
+    int s = t.ss.idx;
+    if (b.cmd) {
+        forth_outer(t, b.cmd);
+        jbuf = std::to_string(t.TOS);   /// Forth result left on stack
+        t.ss.idx = s;                   /// drop it
+    }
+    else t.dispatch(mx);
+    return t.icnt - n;
+}
+
+///
+/// main() of a workload in b.vms VMs, each on its own native thread,
+/// returns wall time of the timed passes, -1 if any VM printed a wrong result
+///
+static thread_local std::string vbuf;   /// console output of a VM thread
+static void vcapture(int, const char *msg) { vbuf += msg; }
+
+static double isolated(const Bench &b, int runs, const std::string &want) {
+    std::atomic<int>  ready(0), bad(0);
+    std::atomic<bool> go(false);
+    std::vector<std::thread> th;
+    for (int k=0; k<b.vms; k++) th.emplace_back([&]{
+        VM vm;
+        vm_use(&vm);
+        forth_setup(vcapture);
+        java_setup(vcapture);
+        java_load(b.cls);
+        Thread t;
+        t.init(Loader::active());
+        IU mx = gPool.get_method("main");
+        t.dispatch(mx);                 /// warm up (quickening, caches)
+        ready++;
+        while (!go) yield();
+        for (int i=0; i<runs; i++) t.dispatch(mx);
+        if (result(vbuf) != want) bad++;
+        vm_use(0);
+    });
+    while (ready < b.vms) yield();
+    double t0 = now_ns();
+    go = true;
+    for (auto &x : th) x.join();
+    double ns = now_ns() - t0;
+    return bad ? -1 : ns;
+}
+///
+/// runs jobs of b.cls on b.vms workers, returns wall time from first submit
+/// to last result, -1 if any job printed a wrong result
+///
+static double jobs(const Bench &b, int runs, const std::string &want) {
+    Executor ex(b.vms);
+    std::vector<std::future<JobResult>> f;
+    double t0 = now_ns();
+    for (int i=0; i<runs; i++) f.push_back(ex.submit(b.cls));
+    int bad = 0;
+    for (auto &x : f) if (result(x.get().out) != want) bad++;
+    double ns = now_ns() - t0;
+    return bad ? -1 : ns;
+}
+
+static int run(const Bench &b, int runs) {
+    forth_setup(capture);
+    java_setup(capture);
+    if (!java_load(b.cls)) {
+        fprintf(stderr, "bench: failed to load %s\n", b.cls);
+        return -1;
+    }
+    Thread t;
+    t.init(Loader::active());
+    IU  mx  = b.cmd ? DATA_NA : gPool.get_method("main");
+    U32 ops = 0;
+    double t0, ns;
+    if (b.unit == UNIT_CLASS) {         /// one class file slot per pass
+        runs = CLSFILE_MAX - 1 - Loader::active();
+        t0 = now_ns();
+        for (int i=0; i<runs; i++) java_load(b.cls);
+        ns = now_ns() - t0;
+        ops = 1;
+    }
+    else {
+        if (b.setup) forth_outer(t, b.setup);
+        t.cgoto = false;                /// counting pass (reference engine)
+        jbuf.clear();
+        ops = pass(t, b, mx);
+        t.cgoto = true;
+        pass(t, b, mx);                 /// warm up (quickening, caches)
+        t0 = now_ns();
+        for (int i=0; i<runs; i++) pass(t, b, mx);
+        ns = now_ns() - t0;
+        if (b.unit == UNIT_TOKEN) ops = tokens(b.cmd);
+        if (b.unit == UNIT_LOCK || b.unit == UNIT_OBJ || b.unit == UNIT_MSG) ops = (U32)atoi(result().c_str());
+        if (b.unit == UNIT_JOB) {       /// whole job, setup and load included
+            ns  = jobs(b, runs, result());
+            ops = 1;
+        }
+        else if (b.vms) {               /// same work in independent VMs at once
+            ns = isolated(b, runs, result());
+            ops *= b.vms;
+        }
+        if (ns < 0) {
+            fprintf(stderr, "bench: %s result differs across VMs\n", b.name);
+            return -1;
+        }
+    }
+    double ns_run = ns / runs;
+    printf("{\"name\":\"%s\",\"unit\":\"%s\",\"runs\":%d,\"ns_per_run\":%.0f,"
+           "\"ops_per_run\":%u,\"ns_per_op\":%.2f,\"ops_per_sec\":%.0f,"
+           "\"ss_max\":%d,\"rs_max\":%d,\"pmem\":%d,\"heap_max\":%d,"
+           "\"vt\":%d,\"cv\":%d,\"iv\":%d,\"ic\":%d,\"hx\":%d,"
+           "\"gc\":%u,\"gc_live\":%u,\"gc_max_ns\":%u,\"gc_avg_ns\":%u,"
+           "\"mon_inflate\":%u,\"mon_block\":%u,\"tlab\":%u,\"chan_park\":%u,\"result\":\"%s\"}\n",
+           b.name, unit_name[b.unit], runs, ns_run, ops, ns_run / ops, ops * 1e9 / ns_run,
+           t.ss.max, t.rs.max, gPool.pmem.idx, gPool.heap.max,
+           gPool.vt.idx, gPool.cv.idx, gPool.iv.idx, gPool.ic.idx, gPool.hx.idx,
+           gGC.n, gGC.live, gGC.t_max, gGC.n ? (U32)(gGC.t_sum / gGC.n) : 0,
+           gMon.inflated, gMon.blocked, gPool.tlab_n, gChan.parked,
+           result().c_str());
+    return 0;
+}
+
+int main(int ac, char *av[]) {
+    int runs = 100, sel = 0;
+    for (int i=1; i<ac; i++) {
+        if (av[i][0]=='-' && av[i][1]=='n') runs = atoi(&av[i][2]);
+        else sel++;
+    }
+    int err = 0;
+    for (int k=0; k<NBENCH; k++) {
+        bool on = !sel;
+        for (int i=1; i<ac && !on; i++) on = !strcmp(av[i], list[k].name);
+        if (!on) continue;
+        fflush(stdout);
+        pid_t pid = fork();             /// fresh VM per workload
+        if (pid == 0) _exit(run(list[k], runs) ? 1 : 0);
+        int st = 0;
+        waitpid(pid, &st, 0);
+        if (!WIFEXITED(st) || WEXITSTATUS(st)) {
+            fprintf(stderr, "bench: %s failed\n", list[k].name);
+            err = 1;
+        }
+    }
+    return err;
+}
@@ -0,0 +1,13 @@
+"""Boom.class as javac compiles Boom.java, run from tests: python3 gen/boom.py"""
+import os, sys; sys.path.insert(0, os.path.dirname(__file__))
+from jasm import *
+c = Class('Boom'); p = c.p; init(c)
+st = p.method('Sleeper', 'start', '()V')
+# main: 1 s
+c.method('main', '([Ljava/lang/String;)V', [
+    ('new', p.cls('Sleeper')), ('dup',), ('iconst_1',), ('bipush', 20),
+    ('invokespecial', p.method('Sleeper', '<init>', '(II)V')), ('astore_1',),
+    ('aload_1',), ('invokevirtual', st),
+    ('aload_1',), ('invokevirtual', st),
+    ('return',)], 4, 2, 0x09)
+c.save('Boom.class')
@@ -0,0 +1,95 @@
+"""Floats.class as javac compiles Floats.java, run from tests: python3 gen/floats.py"""
+import os, sys; sys.path.insert(0, os.path.dirname(__file__))
+from jasm import *
+c = Class('Floats'); p = c.p
+c.field('total', 'D', 0x08)
+for f in ('kp', 'ki', 'kd', 'prev'): c.field(f, 'F')
+c.field('integ', 'D')
+out = p.field('java/lang/System', 'out', 'Ljava/io/PrintStream;')
+pl = {t: p.method('java/io/PrintStream', 'println', '(%s)V' % t) for t in 'IJFD'}
+F = {f: p.field('Floats', f, 'F') for f in ('kp', 'ki', 'kd', 'prev')}
+integ = p.field('Floats', 'integ', 'D'); tot = p.field('Floats', 'total', 'D')
+init = p.method('Floats', '<init>', '(FFF)V'); step = p.method('Floats', 'step', '(FF)F'); hyp = p.method('Floats', 'hyp', '(DFD)D')
+c.method('<init>', '(FFF)V', [('aload_0',), ('invokespecial', p.method('java/lang/Object', '<init>', '()V')),
+    ('aload_0',), ('fload_1',), ('putfield', F['kp']), ('aload_0',), ('fload_2',), ('putfield', F['ki']),
+    ('aload_0',), ('fload_3',), ('putfield', F['kd']), ('return',)], 2, 4, 0)
+# float step(float err, float dt): 0 this, 1 err, 2 dt, 3 der
+c.method('step', '(FF)F', [('aload_0',), ('dup',), ('getfield', integ), ('fload_1',), ('fload_2',), ('fmul',), ('f2d',), ('dadd',),
+    ('putfield', integ),
+    ('fload_1',), ('aload_0',), ('getfield', F['prev']), ('fsub',), ('fload_2',), ('fdiv',), ('fstore_3',),
+    ('aload_0',), ('fload_1',), ('putfield', F['prev']),
+    ('aload_0',), ('getfield', F['kp']), ('fload_1',), ('fmul',), ('f2d',),
+    ('aload_0',), ('getfield', F['ki']), ('f2d',), ('aload_0',), ('getfield', integ), ('dmul',), ('dadd',),
+    ('aload_0',), ('getfield', F['kd']), ('fload_3',), ('fmul',), ('f2d',), ('dadd',), ('d2f',), ('freturn',)], 6, 4, 0x01)
+# static double hyp(double a, float b, double c): a*a + b*b + c % 2.0
+c.method('hyp', '(DFD)D', [('dload_0',), ('dload_0',), ('dmul',), ('fload_2',), ('fload_2',), ('fmul',), ('f2d',), ('dadd',),
+    ('dload_3',), ('ldc2_w', p.double(2.0)), ('drem',), ('dadd',), ('dreturn',)], 6, 5, 0x09)
+# conversions and rem on parameters
+M = {}
+for n, t, code, stack, nl in (
+        ('f2i', '(F)I', [('fload_0',), ('f2i',), ('ireturn',)], 1, 1),
+        ('d2i', '(D)I', [('dload_0',), ('d2i',), ('ireturn',)], 2, 2),
+        ('f2l', '(F)J', [('fload_0',), ('f2l',), ('lreturn',)], 2, 1),
+        ('d2l', '(D)J', [('dload_0',), ('d2l',), ('lreturn',)], 2, 2),
+        ('l2f', '(J)F', [('lload_0',), ('l2f',), ('freturn',)], 2, 2),
+        ('l2d', '(J)D', [('lload_0',), ('l2d',), ('dreturn',)], 2, 2),
+        ('frem', '(FF)F', [('fload_0',), ('fload_1',), ('frem',), ('freturn',)], 2, 2),
+        ('drem', '(DD)D', [('dload_0',), ('dload_2',), ('drem',), ('dreturn',)], 4, 4)):
+    c.method(n, t, code, stack, nl, 0x08); M[n] = p.method('Floats', n, t)
+# comparisons, javac picks the *cmpg/*cmpl variant that makes NaN false
+for n, t, ld, cmp, br, r in (
+        ('lt', '(FF)I', ('fload_0', 'fload_1'), 'fcmpg', 'ifge', 'iconst_m1'),
+        ('gt', '(FF)I', ('fload_0', 'fload_1'), 'fcmpl', 'ifle', 'iconst_1'),
+        ('dlt', '(DD)I', ('dload_0', 'dload_2'), 'dcmpg', 'ifge', 'iconst_m1'),
+        ('dgt', '(DD)I', ('dload_0', 'dload_2'), 'dcmpl', 'ifle', 'iconst_1')):
+    w = 4 if t[1] == 'D' else 2
+    c.method(n, t, [(ld[0],), (ld[1],), (cmp,), (br, 'f:'), (r,), ('goto', 'r:'),
+        'f:', ('iconst_0',), 'r:', ('ireturn',)], w, w, 0x08)
+    M[n] = p.method('Floats', n, t)
+def P(t, *ops): return [('getstatic', out)] + list(ops) + [('invokevirtual', pl[t])]
+# main: 1 pid, 2 y, 3 i, 4 u, then 3 d, 4 f, 5 i, then 5 nan
+code = [('new', p.cls('Floats')), ('dup',), ('ldc', p.float(0.6)), ('ldc', p.float(0.1)), ('ldc', p.float(0.05)),
+    ('invokespecial', init), ('astore_1',),
+    ('fconst_0',), ('fstore_2',), ('iconst_0',), ('istore_3',),
+    'l:', ('iload_3',), ('bipush', 50), ('if_icmpge', 'e:'),
+    ('aload_1',), ('fconst_1',), ('fload_2',), ('fsub',), ('ldc', p.float(0.1)), ('invokevirtual', step), ('fstore', 4),
+    ('fload_2',), ('fload', 4), ('fload_2',), ('fsub',), ('ldc', p.float(0.2)), ('fmul',), ('fadd',), ('fstore_2',),
+    ('iinc', 3, 1), ('goto', 'l:'),
+    'e:'] + P('F', ('fload_2',)) + P('D', ('aload_1',), ('getfield', integ)) + [
+    ('iconst_4',), ('newarray', 7), ('astore_3',), ('iconst_4',), ('newarray', 6), ('astore', 4),
+    ('iconst_0',), ('istore', 5),
+    'l2:', ('iload', 5), ('iconst_4',), ('if_icmpge', 'e2:'),
+    ('aload_3',), ('iload', 5), ('iload', 5), ('i2d',), ('ldc2_w', p.double(0.25)), ('dmul',), ('dastore',),
+    ('aload', 4), ('iload', 5), ('iload', 5), ('i2f',), ('ldc', p.float(3.0)), ('fdiv',), ('fastore',),
+    ('getstatic', tot), ('aload_3',), ('iload', 5), ('daload',), ('aload', 4), ('iload', 5), ('faload',), ('f2d',),
+    ('dadd',), ('dadd',), ('putstatic', tot),
+    ('iinc', 5, 1), ('goto', 'l2:'),
+    'e2:'] + P('D', ('getstatic', tot)) \
+    + P('D', ('ldc2_w', p.double(3.0)), ('ldc', p.float(4.0)), ('ldc2_w', p.double(7.5)), ('invokestatic', hyp)) \
+    + P('F', ('ldc', p.float(3.14159))) \
+    + P('I', ('ldc', p.int(100000))) \
+    + P('F', ('ldc', p.float(7.5)), ('fconst_2',), ('invokestatic', M['frem'])) \
+    + P('D', ('ldc2_w', p.double(-7.5)), ('ldc2_w', p.double(2.0)), ('invokestatic', M['drem'])) \
+    + P('I', ('ldc', p.float(3.99)), ('invokestatic', M['f2i'])) \
+    + P('I', ('ldc2_w', p.double(-2.5)), ('invokestatic', M['d2i'])) \
+    + P('I', ('ldc2_w', p.double(1e20)), ('invokestatic', M['d2i'])) \
+    + P('J', ('ldc2_w', p.double(1e19)), ('invokestatic', M['d2l'])) \
+    + P('J', ('ldc', p.float(-3.7)), ('invokestatic', M['f2l'])) \
+    + P('F', ('ldc2_w', p.long(1 << 40)), ('invokestatic', M['l2f'])) \
+    + P('D', ('ldc2_w', p.long(1 << 40)), ('invokestatic', M['l2d'])) \
+    + P('F', ('aload', 4), ('iconst_1',), ('faload',)) \
+    + P('D', ('ldc2_w', p.double(-0.1))) \
+    + [('ldc', p.float(float('nan'))), ('fstore', 5)] \
+    + P('F', ('fload', 5)) \
+    + P('I', ('fload', 5), ('fconst_1',), ('invokestatic', M['lt'])) \
+    + P('I', ('fload', 5), ('fconst_1',), ('invokestatic', M['gt'])) \
+    + P('I', ('fload', 5), ('f2d',), ('dconst_1',), ('invokestatic', M['dlt'])) \
+    + P('I', ('fload', 5), ('f2d',), ('dconst_1',), ('invokestatic', M['dgt'])) \
+    + P('I', ('ldc', p.float(2.5)), ('ldc', p.float(3.5)), ('invokestatic', M['lt'])) \
+    + P('I', ('ldc', p.float(2.5)), ('ldc', p.float(3.5)), ('invokestatic', M['gt'])) \
+    + P('F', ('ldc', p.float(1e-5))) \
+    + P('D', ('ldc2_w', p.double(-1.0))) \
+    + P('F', ('fload_2',), ('fneg',), ('f2d',), ('d2f',)) \
+    + [('return',)]
+c.method('main', '([Ljava/lang/String;)V', code, 6, 6, 0x09)
+c.save('Floats.class')
@@ -0,0 +1,120 @@
+"""minimal class file assembler, writes test classes as javac would compile them"""
+import struct
+
+OPS = {
+ 'nop':0,'aconst_null':1,'iconst_m1':2,'iconst_0':3,'iconst_1':4,'iconst_2':5,'iconst_3':6,'iconst_4':7,'iconst_5':8,
+ 'lconst_0':9,'lconst_1':10,'fconst_0':11,'fconst_1':12,'fconst_2':13,'dconst_0':14,'dconst_1':15,
+ 'bipush':0x10,'sipush':0x11,'ldc':0x12,'ldc_w':0x13,'ldc2_w':0x14,
+ 'iload':0x15,'lload':0x16,'fload':0x17,'dload':0x18,'aload':0x19,
+ 'iload_0':0x1a,'iload_1':0x1b,'iload_2':0x1c,'iload_3':0x1d,'lload_0':0x1e,'lload_1':0x1f,'lload_2':0x20,'lload_3':0x21,
+ 'fload_0':0x22,'fload_1':0x23,'fload_2':0x24,'fload_3':0x25,'dload_0':0x26,'dload_1':0x27,'dload_2':0x28,'dload_3':0x29,
+ 'aload_0':0x2a,'aload_1':0x2b,'aload_2':0x2c,'aload_3':0x2d,
+ 'iaload':0x2e,'laload':0x2f,'faload':0x30,'daload':0x31,'aaload':0x32,'baload':0x33,'caload':0x34,'saload':0x35,
+ 'istore':0x36,'lstore':0x37,'fstore':0x38,'dstore':0x39,'astore':0x3a,
+ 'istore_0':0x3b,'istore_1':0x3c,'istore_2':0x3d,'istore_3':0x3e,'lstore_0':0x3f,'lstore_1':0x40,'lstore_2':0x41,'lstore_3':0x42,
+ 'fstore_0':0x43,'fstore_1':0x44,'fstore_2':0x45,'fstore_3':0x46,'dstore_0':0x47,'dstore_1':0x48,'dstore_2':0x49,'dstore_3':0x4a,
+ 'astore_0':0x4b,'astore_1':0x4c,'astore_2':0x4d,'astore_3':0x4e,
+ 'iastore':0x4f,'lastore':0x50,'fastore':0x51,'dastore':0x52,'aastore':0x53,'bastore':0x54,'castore':0x55,'sastore':0x56,
+ 'pop':0x57,'pop2':0x58,'dup':0x59,'dup_x1':0x5a,'dup_x2':0x5b,'dup2':0x5c,'dup2_x1':0x5d,'dup2_x2':0x5e,'swap':0x5f,
+ 'iadd':0x60,'ladd':0x61,'fadd':0x62,'dadd':0x63,'isub':0x64,'lsub':0x65,'fsub':0x66,'dsub':0x67,
+ 'imul':0x68,'lmul':0x69,'fmul':0x6a,'dmul':0x6b,'idiv':0x6c,'ldiv':0x6d,'fdiv':0x6e,'ddiv':0x6f,
+ 'irem':0x70,'lrem':0x71,'frem':0x72,'drem':0x73,'ineg':0x74,'lneg':0x75,'fneg':0x76,'dneg':0x77,
+ 'ishl':0x78,'lshl':0x79,'ishr':0x7a,'lshr':0x7b,'iushr':0x7c,'lushr':0x7d,'iand':0x7e,'land':0x7f,
+ 'ior':0x80,'lor':0x81,'ixor':0x82,'lxor':0x83,'iinc':0x84,
+ 'i2l':0x85,'i2f':0x86,'i2d':0x87,'l2i':0x88,'l2f':0x89,'l2d':0x8a,'f2i':0x8b,'f2l':0x8c,'f2d':0x8d,
+ 'd2i':0x8e,'d2l':0x8f,'d2f':0x90,'i2b':0x91,'i2c':0x92,'i2s':0x93,
+ 'lcmp':0x94,'fcmpl':0x95,'fcmpg':0x96,'dcmpl':0x97,'dcmpg':0x98,
+ 'ifeq':0x99,'ifne':0x9a,'iflt':0x9b,'ifge':0x9c,'ifgt':0x9d,'ifle':0x9e,
+ 'if_icmpeq':0x9f,'if_icmpne':0xa0,'if_icmplt':0xa1,'if_icmpge':0xa2,'if_icmpgt':0xa3,'if_icmple':0xa4,
+ 'if_acmpeq':0xa5,'if_acmpne':0xa6,'goto':0xa7,
+ 'ireturn':0xac,'lreturn':0xad,'freturn':0xae,'dreturn':0xaf,'areturn':0xb0,'return':0xb1,
+ 'getstatic':0xb2,'putstatic':0xb3,'getfield':0xb4,'putfield':0xb5,
+ 'invokevirtual':0xb6,'invokespecial':0xb7,'invokestatic':0xb8,'invokeinterface':0xb9,
+ 'new':0xbb,'newarray':0xbc,'anewarray':0xbd,'arraylength':0xbe,'athrow':0xbf,
+ 'checkcast':0xc0,'instanceof':0xc1,'monitorenter':0xc2,'monitorexit':0xc3,
+ 'ifnull':0xc6,'ifnonnull':0xc7,
+}
+BRANCH = {o for o in OPS if o.startswith('if') or o == 'goto'}
+U1 = {'bipush','ldc','iload','lload','fload','dload','aload','istore','lstore','fstore','dstore','astore','newarray'}
+CP2 = {'ldc_w','ldc2_w','getstatic','putstatic','getfield','putfield','invokevirtual','invokespecial',
+       'invokestatic','new','anewarray','checkcast','instanceof'}
+
+class Pool:
+    def __init__(s): s.e = []; s.idx = {}
+    def add(s, key, data, wide=False):
+        if key in s.idx: return s.idx[key]
+        s.e.append(data); i = len(s.e); s.idx[key] = i
+        if wide: s.e.append(None)
+        return i
+    def utf8(s, t): b = t.encode(); return s.add(('u', t), b'\x01' + struct.pack('>H', len(b)) + b)
+    def cls(s, n):  return s.add(('c', n), b'\x07' + struct.pack('>H', s.utf8(n)))
+    def string(s, t): return s.add(('s', t), b'\x08' + struct.pack('>H', s.utf8(t)))
+    def int(s, v):  return s.add(('i', v), b'\x03' + struct.pack('>i', v))
+    def float(s, v):return s.add(('f', v), b'\x04' + struct.pack('>f', v))
+    def long(s, v): return s.add(('l', v), b'\x05' + struct.pack('>q', v), True)
+    def double(s, v):return s.add(('d', v), b'\x06' + struct.pack('>d', v), True)
+    def nt(s, n, t): return s.add(('nt', n, t), b'\x0c' + struct.pack('>HH', s.utf8(n), s.utf8(t)))
+    def ref(s, tag, c, n, t):
+        return s.add((tag, c, n, t), bytes([tag]) + struct.pack('>HH', s.cls(c), s.nt(n, t)))
+    def field(s, c, n, t):  return s.ref(9, c, n, t)
+    def method(s, c, n, t): return s.ref(10, c, n, t)
+    def imethod(s, c, n, t): return s.ref(11, c, n, t)
+    def bytes(s):
+        out = b''
+        for x in s.e:
+            if x is not None: out += x
+        return struct.pack('>H', len(s.e) + 1) + out
+
+class Class:
+    def __init__(s, name, supr='java/lang/Object', flags=0x20):
+        s.p = Pool(); s.name = name; s.supr = supr; s.flags = flags
+        s.fields = []; s.methods = []
+    def field(s, n, t, flags=0):
+        s.fields.append((flags, s.p.utf8(n), s.p.utf8(t)))
+    def method(s, n, t, code, stack=8, locals=8, flags=0, exc=()):
+        """code: list of tuples (op, arg...) or label strings ending with ':'
+        exc: (start, end, handler, catch class index) labels, exception table"""
+        body = s.asm(code)
+        et = b''.join(struct.pack('>HHHH', s.labels[a], s.labels[b], s.labels[h], c) for a, b, h, c in exc)
+        ca = struct.pack('>HHI', stack, locals, len(body)) + body + struct.pack('>H', len(exc)) + et + struct.pack('>H', 0)
+        attr = struct.pack('>HI', s.p.utf8('Code'), len(ca)) + ca
+        s.methods.append(struct.pack('>HHHH', flags, s.p.utf8(n), s.p.utf8(t), 1) + attr)
+    def asm(s, code):
+        def size(ins):
+            op = ins[0]
+            if op in BRANCH or op in CP2 or op == 'sipush': return 3
+            if op in U1: return 2
+            if op == 'iinc': return 3
+            if op == 'invokeinterface': return 5
+            return 1
+        labels, pc = {}, 0
+        for ins in code:
+            if isinstance(ins, str): labels[ins] = pc; continue
+            pc += size(ins)
+        s.labels = labels
+        out, pc = b'', 0
+        for ins in code:
+            if isinstance(ins, str): continue
+            op, a = ins[0], ins[1:]
+            b = bytes([OPS[op]])
+            if op in BRANCH: b += struct.pack('>h', labels[a[0]] - pc)
+            elif op == 'sipush': b += struct.pack('>h', a[0])
+            elif op in U1: b += struct.pack('>B' if op != 'bipush' else '>b', a[0])
+            elif op == 'iinc': b += struct.pack('>Bb', a[0], a[1])
+            elif op in CP2: b += struct.pack('>H', a[0])
+            elif op == 'invokeinterface': b += struct.pack('>HBB', a[0], a[1], 0)
+            out += b; pc += len(b)
+        return out
+    def save(s, path):
+        this = s.p.cls(s.name); sup = s.p.cls(s.supr)
+        body = struct.pack('>HHH', s.flags, this, sup) + struct.pack('>H', 0)
+        body += struct.pack('>H', len(s.fields))
+        for f in s.fields: body += struct.pack('>HHHH', f[0], f[1], f[2], 0)
+        body += struct.pack('>H', len(s.methods)) + b''.join(s.methods)
+        body += struct.pack('>H', 0)
+        data = struct.pack('>IHH', 0xcafebabe, 0, 52) + s.p.bytes() + body
+        open(path, 'wb').write(data)
+
+def init(c, supr='java/lang/Object'):
+    """default constructor"""
+    c.method('<init>', '()V', [('aload_0',), ('invokespecial', c.p.method(supr, '<init>', '()V')), ('return',)], 1, 1)
@@ -0,0 +1,75 @@
+"""Longs.class as javac compiles Longs.java, run from tests: python3 gen/longs.py"""
+import os, sys; sys.path.insert(0, os.path.dirname(__file__))
+from jasm import *
+c = Class('Longs'); p = c.p; init(c)
+c.field('total', 'J', 0x08); c.field('acc', 'J')
+out = p.field('java/lang/System', 'out', 'Ljava/io/PrintStream;')
+plJ = p.method('java/io/PrintStream', 'println', '(J)V')
+plI = p.method('java/io/PrintStream', 'println', '(I)V')
+tot = p.field('Longs', 'total', 'J'); acc = p.field('Longs', 'acc', 'J')
+fib = p.method('Longs', 'fib', '(I)J'); add = p.method('Longs', 'add', '(JI)J'); mix = p.method('Longs', 'mix', '(JIJ)J')
+quo = p.method('Longs', 'quot', '(JJ)J'); rem = p.method('Longs', 'rem', '(JJ)J')
+iqu = p.method('Longs', 'iquot', '(II)I'); irm = p.method('Longs', 'irem', '(II)I'); ish = p.method('Longs', 'ishift', '(II)I')
+# static long fib(int n): 0 n, 1 a, 3 b, 5 i, 6 c
+c.method('fib', '(I)J', [('lconst_0',), ('lstore_1',), ('lconst_1',), ('lstore_3',), ('iconst_0',), ('istore', 5),
+    'l:', ('iload', 5), ('iload_0',), ('if_icmpge', 'e:'),
+    ('lload_1',), ('lload_3',), ('ladd',), ('lstore', 6), ('lload_3',), ('lstore_1',), ('lload', 6), ('lstore_3',),
+    ('iinc', 5, 1), ('goto', 'l:'),
+    'e:', ('lload_1',), ('lreturn',)], 4, 8, 0x09)
+# long add(long v, int k): acc += v * k
+c.method('add', '(JI)J', [('aload_0',), ('dup',), ('getfield', acc), ('lload_1',), ('iload_3',), ('i2l',), ('lmul',), ('ladd',),
+    ('putfield', acc), ('aload_0',), ('getfield', acc), ('lreturn',)], 7, 4, 0x01)
+# static long mix(long a, int s, long b): ((a << s) ^ (b >>> s)) | (a >> 60)
+c.method('mix', '(JIJ)J', [('lload_0',), ('iload_2',), ('lshl',), ('lload_3',), ('iload_2',), ('lushr',), ('lxor',),
+    ('lload_0',), ('bipush', 60), ('lshr',), ('lor',), ('lreturn',)], 5, 5, 0x09)
+c.method('quot', '(JJ)J', [('lload_0',), ('lload_2',), ('ldiv',), ('lreturn',)], 4, 4, 0x09)
+c.method('rem', '(JJ)J', [('lload_0',), ('lload_2',), ('lrem',), ('lreturn',)], 4, 4, 0x09)
+c.method('iquot', '(II)I', [('iload_0',), ('iload_1',), ('idiv',), ('ireturn',)], 2, 2, 0x08)
+c.method('irem', '(II)I', [('iload_0',), ('iload_1',), ('irem',), ('ireturn',)], 2, 2, 0x08)
+# static int ishift(int a, int s): (a << s) ^ (a >> s) ^ (a >>> s)
+c.method('ishift', '(II)I', [('iload_0',), ('iload_1',), ('ishl',), ('iload_0',), ('iload_1',), ('ishr',), ('ixor',),
+    ('iload_0',), ('iload_1',), ('iushr',), ('ixor',), ('ireturn',)], 3, 2, 0x08)
+# main: 1 o, 2 big, 4 i then a, 5 i, 6 r, 8 n, 9 k
+code = [('new', p.cls('Longs')), ('dup',), ('invokespecial', p.method('Longs', '<init>', '()V')), ('astore_1',),
+    ('getstatic', out), ('bipush', 90), ('invokestatic', fib), ('invokevirtual', plJ),
+    ('ldc2_w', p.long(10000000000)), ('lstore_2',),
+    ('getstatic', out), ('lload_2',), ('ldc2_w', p.long(7)), ('ldiv',), ('invokevirtual', plJ),
+    ('getstatic', out), ('lload_2',), ('ldc2_w', p.long(7)), ('lrem',), ('invokevirtual', plJ),
+    ('getstatic', out), ('lload_2',), ('lneg',), ('invokevirtual', plJ),
+    ('iconst_1',), ('istore', 4),
+    'l1:', ('iload', 4), ('iconst_4',), ('if_icmpgt', 'e1:'),
+    ('aload_1',), ('lload_2',), ('iload', 4), ('invokevirtual', add), ('pop2',), ('iinc', 4, 1), ('goto', 'l1:'),
+    'e1:', ('getstatic', out), ('aload_1',), ('getfield', acc), ('invokevirtual', plJ),
+    ('iconst_5',), ('newarray', 11), ('astore', 4),
+    ('iconst_0',), ('istore', 5),
+    'l2:', ('iload', 5), ('iconst_5',), ('if_icmpge', 'e2:'),
+    ('aload', 4), ('iload', 5), ('iload', 5), ('i2l',), ('bipush', 40), ('lshl',), ('lastore',),
+    ('getstatic', tot), ('aload', 4), ('iload', 5), ('laload',), ('ladd',), ('putstatic', tot),
+    ('iinc', 5, 1), ('goto', 'l2:'),
+    'e2:', ('getstatic', out), ('getstatic', tot), ('invokevirtual', plJ),
+    ('getstatic', out), ('getstatic', tot), ('bipush', 32), ('lushr',), ('l2i',), ('invokevirtual', plI),
+    ('getstatic', out), ('ldc2_w', p.long(0x7123456789ABCDEF)), ('iconst_4',), ('ldc2_w', p.long(-2)),
+    ('invokestatic', mix), ('invokevirtual', plJ),
+    ('aload_1',), ('lload_2',), ('lconst_1',), ('ladd',), ('dup2_x1',), ('putfield', acc), ('lstore', 6),
+    ('getstatic', out), ('lload', 6), ('lload_2',), ('lcmp',), ('ifle', 'f1:'), ('iconst_1',), ('goto', 'g1:'),
+    'f1:', ('iconst_m1',), 'g1:', ('invokevirtual', plI),
+    ('getstatic', out), ('lload_2',), ('aload_1',), ('getfield', acc), ('lcmp',), ('ifle', 'f2:'), ('iconst_1',), ('goto', 'g2:'),
+    'f2:', ('iconst_m1',), 'g2:', ('invokevirtual', plI),
+    ('aload', 4), ('iconst_0',), ('lload_2',), ('dup2_x2',), ('lastore',), ('lstore', 6),
+    ('getstatic', out), ('lload', 6), ('aload', 4), ('iconst_0',), ('laload',), ('ladd',), ('invokevirtual', plJ),
+    ('iconst_5',), ('istore', 8),
+    ('getstatic', out), ('iload', 8), ('i2l',), ('ldc2_w', p.long(1000000000)), ('lmul',), ('invokevirtual', plJ),
+    ('getstatic', out), ('ldc2_w', p.long(-0x8000000000000000)), ('ldc2_w', p.long(-1)), ('invokestatic', quo), ('invokevirtual', plJ),
+    ('getstatic', out), ('ldc2_w', p.long(-0x8000000000000000)), ('ldc2_w', p.long(-1)), ('invokestatic', rem), ('invokevirtual', plJ),
+    ('getstatic', out), ('ldc', p.int(-0x80000000)), ('iconst_m1',), ('invokestatic', iqu), ('invokevirtual', plI),
+    ('getstatic', out), ('ldc', p.int(-0x80000000)), ('iconst_m1',), ('invokestatic', irm), ('invokevirtual', plI),
+    ('getstatic', out), ('ldc2_w', p.long(0x7123456789ABCDEF)), ('bipush', 68), ('ldc2_w', p.long(-2)),
+    ('invokestatic', mix), ('invokevirtual', plJ),
+    ('getstatic', out), ('bipush', -3), ('bipush', 33), ('invokestatic', ish), ('invokevirtual', plI),
+    ('iconst_0',), ('istore', 9),
+    'l3:', ('iload', 9), ('sipush', 300), ('if_icmpge', 'e3:'),
+    ('lconst_0',), ('invokestatic', p.method('java/lang/Thread', 'sleep', '(J)V')), ('iinc', 9, 1), ('goto', 'l3:'),
+    'e3:', ('getstatic', out), ('iload', 9), ('invokevirtual', plI),
+    ('return',)]
+c.method('main', '([Ljava/lang/String;)V', code, 6, 10, 0x09)
+c.save('Longs.class')
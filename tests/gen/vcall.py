@@ -0,0 +1,28 @@
+"""Base, Other, Derived and Vcall classes as javac compiles them, run from tests: python3 gen/vcall.py"""
+import os, sys; sys.path.insert(0, os.path.dirname(__file__))
+from jasm import *
+b = Class('Base'); init(b)
+b.method('f', '()I', [('iconst_1',), ('ireturn',)], 1, 1)
+b.method('g', '()I', [('iconst_2',), ('ireturn',)], 1, 1)
+b.save('Base.class')
+o = Class('Other'); init(o)
+o.method('g', '()I', [('bipush', 30), ('ireturn',)], 1, 1)
+o.method('h', '()I', [('bipush', 40), ('ireturn',)], 1, 1)
+o.save('Other.class')
+d = Class('Derived', 'Base'); init(d, 'Base')
+d.save('Derived.class')
+# main: 1 d, 2 b, 3 o
+m = Class('Vcall'); p = m.p; init(m)
+out = p.field('java/lang/System', 'out', 'Ljava/io/PrintStream;')
+pl  = p.method('java/io/PrintStream', 'println', '(I)V')
+def P(*ops): return [('getstatic', out)] + list(ops) + [('invokevirtual', pl)]
+m.method('main', '([Ljava/lang/String;)V', [
+    ('new', p.cls('Derived')), ('dup',), ('invokespecial', p.method('Derived', '<init>', '()V')), ('astore_1',),
+    ('aload_1',), ('astore_2',),
+    ('new', p.cls('Other')), ('dup',), ('invokespecial', p.method('Other', '<init>', '()V')), ('astore_3',)]
+    + P(('aload_1',), ('invokevirtual', p.method('Derived', 'g', '()I')))
+    + P(('aload_2',), ('invokevirtual', p.method('Base', 'g', '()I')))
+    + P(('aload_3',), ('invokevirtual', p.method('Other', 'g', '()I')))
+    + P(('aload_2',), ('invokevirtual', p.method('Base', 'f', '()I')))
+    + [('return',)], 2, 4, 0x09)
+m.save('Vcall.class')